@@ -1,3 +1,4 @@
+#include <cache.hpp>
 #include <cstdint>
 #include <evaluator.hpp>
 #include <fstream>
@@ -7,15 +8,12 @@
 #include <parser.hpp>
 #include <print>
 #include <repl.hpp>
+#include <snapshot.hpp>
 #include <sstream>
+#include <string_view>
 
-int32_t main(int argc, char *argv[]) {
-  if (argc < 2) {
-    repl::run();
-    return 0;
-  }
-
-  char *file_name = argv[1];
+static auto run(const string &file_name,
+                std::shared_ptr<object::Environment> &env) -> int32_t {
   std::ifstream file(file_name);
   if (!file.is_open()) {
     std::println("failed to open file {}", file_name);
@@ -28,18 +26,22 @@ int32_t main(int argc, char *argv[]) {
   data = ss.str();
 
   auto lexer = lexer::Lexer(file_name, data);
-  auto parser = parser::Parser(lexer);
-  auto program = parser.parse();
-  auto errors = parser.get_errors();
+  auto program = cache::load(data, lexer.get_source());
+  if (!program) {
+    auto parser = parser::Parser(lexer);
+    program = parser.parse();
+    auto errors = parser.get_errors();
 
-  if (errors.size() > 0) {
-    for (const auto &e : errors) {
-      std::println("{}", e);
+    if (errors.size() > 0) {
+      for (const auto &e : errors) {
+        std::println("{}", e);
+      }
+      return 1;
     }
-    return 1;
+
+    cache::store(data, program);
   }
 
-  auto env = std::make_shared<object::Environment>();
   auto eval = evaluator::Eval(lexer);
   auto res = eval.eval(std::move(program), env);
   if (evaluator::is_error(res)) {
@@ -49,3 +51,63 @@ int32_t main(int argc, char *argv[]) {
 
   return 0;
 }
+
+static auto usage() -> int32_t {
+  std::println("usage: eta [file]");
+  std::println("       eta --snapshot <out.snap> <file>");
+  std::println("       eta --from-snapshot <in.snap> [file]");
+  return 1;
+}
+
+int32_t main(int argc, char *argv[]) {
+  if (argc < 2) {
+    repl::run();
+    return 0;
+  }
+
+  auto flag = std::string_view(argv[1]);
+  auto env = std::make_shared<object::Environment>();
+
+  if (flag == "--snapshot") {
+    if (argc != 4) {
+      return usage();
+    }
+
+    if (auto res = run(argv[3], env); res != 0) {
+      return res;
+    }
+
+    if (auto res = snapshot::save(argv[2], env); !res) {
+      std::println("{}", res.error());
+      return 1;
+    }
+
+    return 0;
+  }
+
+  if (flag == "--from-snapshot") {
+    if (argc != 3 && argc != 4) {
+      return usage();
+    }
+
+    auto res = snapshot::load(argv[2]);
+    if (!res) {
+      std::println("{}", res.error());
+      return 1;
+    }
+
+    env = std::make_shared<object::Environment>(res.value());
+    if (argc == 3) {
+      repl::run(env);
+      return 0;
+    }
+
+    return run(argv[3], env);
+  }
+
+  if (argc != 2) {
+    return usage();
+  }
+
+  return run(argv[1], env);
+}
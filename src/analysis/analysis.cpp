@@ -0,0 +1,160 @@
+#include <analysis.hpp>
+#include <ast.hpp>
+#include <memory>
+
+using namespace ast;
+
+auto analysis::run(const std::shared_ptr<Node> &node) -> void {
+  if (!node) {
+    return;
+  }
+
+  escape(node);
+  capture(node);
+}
+
+auto analysis::children(const std::shared_ptr<Node> &node, const visit_fn &fn)
+    -> void {
+  auto visit = [&](const std::shared_ptr<Node> &child) {
+    if (child) {
+      fn(child);
+    }
+  };
+
+  switch (node->type()) {
+  case ASTType::PROGRAM:
+    for (const auto &stmt : ast::cast<Node, Program>(node)->statements) {
+      visit(stmt);
+    }
+    break;
+
+  case ASTType::BLOCK:
+    for (const auto &stmt : ast::cast<Node, BlockStatement>(node)->statements) {
+      visit(stmt);
+    }
+    break;
+
+  case ASTType::FUNCTION: {
+    auto expr = ast::cast<Node, FunctionLiteral>(node);
+    for (const auto &parm : expr->parameters) {
+      visit(parm);
+    }
+    visit(expr->body);
+    break;
+  }
+
+  case ASTType::ARRAY:
+    for (const auto &e : ast::cast<Node, ArrayLiteral>(node)->elements) {
+      visit(e);
+    }
+    break;
+
+  case ASTType::DICT:
+    for (const auto &[key, value] : ast::cast<Node, DictLiteral>(node)->pairs) {
+      visit(key);
+      visit(value);
+    }
+    break;
+
+  case ASTType::PREFIX:
+    visit(ast::cast<Node, PrefixExpression>(node)->right);
+    break;
+
+  case ASTType::INFIX: {
+    auto expr = ast::cast<Node, InfixExpression>(node);
+    visit(expr->left);
+    visit(expr->right);
+    break;
+  }
+
+  case ASTType::IF: {
+    auto expr = ast::cast<Node, IfExpression>(node);
+    visit(expr->condition);
+    visit(expr->consequence);
+    visit(expr->alternative);
+    break;
+  }
+
+  case ASTType::FOR: {
+    auto expr = ast::cast<Node, ForExpression>(node);
+    visit(expr->intialization);
+    visit(expr->condition);
+    visit(expr->updation);
+    visit(expr->body);
+    break;
+  }
+
+  case ASTType::FORIN: {
+    auto expr = ast::cast<Node, ForInExpression>(node);
+    visit(expr->name);
+    visit(expr->iterable);
+    visit(expr->body);
+    break;
+  }
+
+  case ASTType::ASSIGNMENT: {
+    auto expr = ast::cast<Node, AssignmentExpression>(node);
+    visit(expr->name);
+    visit(expr->value);
+    break;
+  }
+
+  case ASTType::CALL: {
+    auto expr = ast::cast<Node, CallExpression>(node);
+    visit(expr->function);
+    for (const auto &a : expr->arguments) {
+      visit(a);
+    }
+    break;
+  }
+
+  case ASTType::INDEX: {
+    auto expr = ast::cast<Node, IndexExpression>(node);
+    visit(expr->left);
+    visit(expr->index);
+    break;
+  }
+
+  case ASTType::OPASSIGNMENT: {
+    auto expr = ast::cast<Node, OpAssignment>(node);
+    visit(expr->name);
+    visit(expr->value);
+    break;
+  }
+
+  case ASTType::LET: {
+    auto stmt = ast::cast<Node, LetStatement>(node);
+    visit(stmt->name);
+    visit(stmt->value);
+    break;
+  }
+
+  case ASTType::RETURN:
+    visit(ast::cast<Node, ReturnStatement>(node)->value);
+    break;
+
+  case ASTType::EXPRESSION:
+    visit(ast::cast<Node, ExpressionStatement>(node)->expression);
+    break;
+
+  case ASTType::IDENTIFIER:
+  case ASTType::INTEGER:
+  case ASTType::FLOAT:
+  case ASTType::BOOL:
+  case ASTType::STRING:
+  case ASTType::IMPORT:
+    break;
+  }
+}
+
+auto analysis::closes(const std::shared_ptr<Node> &node) -> bool {
+  if (node->type() == ASTType::FUNCTION) {
+    return true;
+  }
+
+  auto res = false;
+  children(node, [&](const std::shared_ptr<Node> &child) {
+    res = res || closes(child);
+  });
+  return res;
+}
@@ -0,0 +1,25 @@
+#ifndef __ETA_ANALYSIS_HPP__
+#define __ETA_ANALYSIS_HPP__
+
+#include <ast.hpp>
+#include <functional>
+#include <memory>
+
+namespace analysis {
+typedef std::function<auto(const std::shared_ptr<ast::Node> &)->void> visit_fn;
+
+// runs every pass over a freshly parsed or decoded tree
+auto run(const std::shared_ptr<ast::Node> &node) -> void;
+
+// calls fn on every direct child of node that is present
+auto children(const std::shared_ptr<ast::Node> &node, const visit_fn &fn)
+    -> void;
+
+// whether a function literal appears anywhere under node
+auto closes(const std::shared_ptr<ast::Node> &node) -> bool;
+
+auto escape(const std::shared_ptr<ast::Node> &node) -> void;
+auto capture(const std::shared_ptr<ast::Node> &node) -> void;
+}; // namespace analysis
+
+#endif
@@ -0,0 +1,85 @@
+#include <analysis.hpp>
+#include <ast.hpp>
+#include <memory>
+#include <set>
+#include <string>
+
+using namespace ast;
+
+namespace {
+struct Scope {
+  std::set<string> refs;
+  std::set<string> locals;
+};
+}; // namespace
+
+static auto function(const std::shared_ptr<FunctionLiteral> &fn) -> void;
+
+static auto collect(const std::shared_ptr<Node> &node, Scope &scope) -> void {
+  switch (node->type()) {
+  case ASTType::IDENTIFIER:
+    scope.refs.insert(ast::cast<Node, Identifier>(node)->value);
+    return;
+
+  case ASTType::LET: {
+    auto stmt = ast::cast<Node, LetStatement>(node);
+    if (stmt->name) {
+      scope.locals.insert(stmt->name->value);
+    }
+    if (stmt->value) {
+      collect(stmt->value, scope);
+    }
+    return;
+  }
+
+  // the loop variable is declared like a let
+  case ASTType::FORIN: {
+    auto expr = ast::cast<Node, ForInExpression>(node);
+    scope.locals.insert(expr->name->value);
+    analysis::children(node, [&](const std::shared_ptr<Node> &child) {
+      collect(child, scope);
+    });
+    return;
+  }
+
+  // a nested function needs its own captures from this scope
+  case ASTType::FUNCTION: {
+    auto expr = ast::cast<Node, FunctionLiteral>(node);
+    function(expr);
+    scope.refs.insert(expr->captures.begin(), expr->captures.end());
+    return;
+  }
+
+  default:
+    analysis::children(node, [&](const std::shared_ptr<Node> &child) {
+      collect(child, scope);
+    });
+    return;
+  }
+}
+
+static auto function(const std::shared_ptr<FunctionLiteral> &fn) -> void {
+  auto scope = Scope();
+  if (fn->body) {
+    collect(fn->body, scope);
+  }
+
+  for (const auto &parm : fn->parameters) {
+    if (parm) {
+      scope.refs.erase(parm->value);
+      scope.locals.erase(parm->value);
+    }
+  }
+
+  fn->captures.assign(scope.refs.begin(), scope.refs.end());
+  fn->locals.assign(scope.locals.begin(), scope.locals.end());
+}
+
+auto analysis::capture(const std::shared_ptr<Node> &node) -> void {
+  if (node->type() == ASTType::FUNCTION) {
+    function(ast::cast<Node, FunctionLiteral>(node));
+    return;
+  }
+
+  children(node, capture);
+}
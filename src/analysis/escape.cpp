@@ -0,0 +1,50 @@
+#include <analysis.hpp>
+#include <ast.hpp>
+#include <memory>
+
+using namespace ast;
+
+// a value escapes when it can outlive the expression that produced
+// it: bound by let or assignment, stored in an array, passed to a
+// function or returned. operands of operators, indices and branch
+// conditions are consumed on the spot and never escape.
+static auto consumed(const std::shared_ptr<Expression> &expr) -> void {
+  if (expr) {
+    expr->escapes = false;
+  }
+}
+
+auto analysis::escape(const std::shared_ptr<Node> &node) -> void {
+  switch (node->type()) {
+  case ASTType::PREFIX:
+    consumed(ast::cast<Node, PrefixExpression>(node)->right);
+    break;
+
+  case ASTType::INFIX: {
+    auto expr = ast::cast<Node, InfixExpression>(node);
+    consumed(expr->left);
+    consumed(expr->right);
+    break;
+  }
+
+  case ASTType::INDEX: {
+    auto expr = ast::cast<Node, IndexExpression>(node);
+    consumed(expr->left);
+    consumed(expr->index);
+    break;
+  }
+
+  case ASTType::IF:
+    consumed(ast::cast<Node, IfExpression>(node)->condition);
+    break;
+
+  case ASTType::FOR:
+    consumed(ast::cast<Node, ForExpression>(node)->condition);
+    break;
+
+  default:
+    break;
+  }
+
+  children(node, escape);
+}
@@ -8,6 +8,7 @@
 #include <string>
 #include <token.hpp>
 #include <types.hpp>
+#include <utility>
 #include <vector>
 
 using std::string;
@@ -34,6 +35,9 @@ enum ASTType : uint8_t {
   LET,
   RETURN,
   EXPRESSION,
+  IMPORT,
+  DICT,
+  FORIN,
 };
 
 template <typename X, typename Y>
@@ -49,7 +53,11 @@ struct Node {
 };
 
 struct Statement : public Node {};
-struct Expression : public Node {};
+struct Expression : public Node {
+  // cleared by the escape analysis when the value is consumed on
+  // the spot by an operator and can never be stored anywhere
+  bool escapes = true;
+};
 
 // ---------------------------------------
 // PROGRAM
@@ -105,6 +113,11 @@ struct FunctionLiteral : public Expression {
   types::Position pos;
   std::vector<std::shared_ptr<Identifier>> parameters;
   std::shared_ptr<BlockStatement> body;
+
+  // filled by the capture analysis, both sorted: names the body
+  // reads from enclosing scopes and names it declares with let
+  std::vector<string> captures;
+  std::vector<string> locals;
 };
 
 // ---------------------------------------
@@ -162,6 +175,19 @@ struct ArrayLiteral : public Expression {
   std::vector<std::shared_ptr<Expression>> elements;
 };
 
+// ---------------------------------------
+// DICT
+struct DictLiteral : public Expression {
+  auto position() -> types::Position;
+  auto type() -> ASTType;
+  auto debug() -> string;
+
+  types::Position pos;
+  std::vector<
+      std::pair<std::shared_ptr<Expression>, std::shared_ptr<Expression>>>
+      pairs;
+};
+
 // ---------------------------------------
 // PREFIX EXPRESSION
 struct PrefixExpression : public Expression {
@@ -214,6 +240,20 @@ struct ForExpression : public Expression {
   std::shared_ptr<BlockStatement> body;
 };
 
+// ---------------------------------------
+// FOR IN EXPRESSION
+// runs the body once per element of an iterable with name bound to it
+struct ForInExpression : public Expression {
+  auto position() -> types::Position;
+  auto type() -> ASTType;
+  auto debug() -> string;
+
+  types::Position pos;
+  std::shared_ptr<Identifier> name;
+  std::shared_ptr<Expression> iterable;
+  std::shared_ptr<BlockStatement> body;
+};
+
 // ---------------------------------------
 // ASSIGNMENT EXPRESSION
 struct AssignmentExpression : public Expression {
@@ -284,5 +324,16 @@ struct ExpressionStatement : public Statement {
   types::Position pos;
   std::shared_ptr<Expression> expression;
 };
+
+// ---------------------------------------
+// IMPORT STATEMENT
+struct ImportStatement : public Statement {
+  auto position() -> types::Position;
+  auto type() -> ASTType;
+  auto debug() -> string;
+
+  types::Position pos;
+  string path;
+};
 }; // namespace ast
 #endif
@@ -86,6 +86,28 @@ auto ForExpression::debug() -> string {
       sinit, scond, supdt, sbody);
 }
 
+// ---------------------------------------
+// FOR IN EXPRESSION
+auto ForInExpression::position() -> types::Position { return pos; }
+auto ForInExpression::type() -> ASTType { return ASTType::FORIN; }
+auto ForInExpression::debug() -> string {
+  string sname = "nil", siter = "nil", sbody = "nil";
+  if (name) {
+    sname = name->debug();
+  }
+
+  if (iterable) {
+    siter = iterable->debug();
+  }
+
+  if (body) {
+    sbody = body->debug();
+  }
+
+  return std::format("{{loop: {{name: {}, iterable: {}, body: {}}}}}", sname,
+                     siter, sbody);
+}
+
 // ---------------------------------------
 // ASSIGNMENT EXPRESSION
 auto AssignmentExpression::position() -> types::Position { return pos; }
@@ -50,3 +50,19 @@ auto ArrayLiteral::debug() -> string {
   res += "]";
   return std::format("{{array: {}}}", res);
 }
+
+// ---------------------------------------
+// Dict
+auto DictLiteral::position() -> types::Position { return pos; }
+auto DictLiteral::type() -> ASTType { return ASTType::DICT; }
+auto DictLiteral::debug() -> string {
+  string res = "{";
+  for (auto const &[i, pair] : pairs | std::views::enumerate) {
+    res += pair.first->debug() + ": " + pair.second->debug();
+    if (pairs.size() - 1 != static_cast<size_t>(i)) {
+      res += ", ";
+    }
+  }
+  res += "}";
+  return std::format("{{dict: {}}}", res);
+}
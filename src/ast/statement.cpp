@@ -43,3 +43,11 @@ auto ExpressionStatement::debug() -> string {
 
   return "nil";
 }
+
+// ---------------------------------------
+// IMPORT STATEMENT
+auto ImportStatement::position() -> types::Position { return pos; }
+auto ImportStatement::type() -> ASTType { return ASTType::IMPORT; }
+auto ImportStatement::debug() -> string {
+  return std::format("{{import: {{path: {}}}}}", path);
+}
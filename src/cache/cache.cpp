@@ -0,0 +1,152 @@
+#include <analysis.hpp>
+#include <ast.hpp>
+#include <cache.hpp>
+#include <cstdlib>
+#include <fcntl.h>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+static const string_view MAGIC = "ETAC";
+
+auto cache::hash(string_view data) -> uint64_t {
+  // FNV-1a
+  uint64_t res = 0xcbf29ce484222325;
+  for (auto c : data) {
+    res ^= static_cast<uint8_t>(c);
+    res *= 0x100000001b3;
+  }
+  return res;
+}
+
+// ETA_CACHE_DIR overrides the location, setting it to an
+// empty value turns the cache off
+static auto directory() -> std::optional<fs::path> {
+  if (auto dir = std::getenv("ETA_CACHE_DIR"); dir) {
+    if (*dir == '\0') {
+      return {};
+    }
+    return fs::path(dir);
+  }
+
+  if (auto dir = std::getenv("XDG_CACHE_HOME"); dir && *dir != '\0') {
+    return fs::path(dir) / "eta";
+  }
+
+  if (auto dir = std::getenv("HOME"); dir && *dir != '\0') {
+    return fs::path(dir) / ".cache" / "eta";
+  }
+
+  return {};
+}
+
+static auto file_path(const fs::path &dir, uint64_t key) -> fs::path {
+  return dir / std::format("{:016x}.etac", key);
+}
+
+auto cache::load(const string &data, uint32_t source)
+    -> std::shared_ptr<ast::Program> {
+  auto dir = directory();
+  if (!dir) {
+    return nullptr;
+  }
+
+  auto key = hash(data);
+  auto fd = ::open(file_path(*dir, key).c_str(), O_RDONLY);
+  if (fd < 0) {
+    return nullptr;
+  }
+
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+    ::close(fd);
+    return nullptr;
+  }
+
+  auto size = static_cast<size_t>(st.st_size);
+  auto mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    return nullptr;
+  }
+
+  auto r = Reader(static_cast<const char *>(mapping), size, source);
+  std::shared_ptr<ast::Program> program;
+
+  auto magic_ok = true;
+  for (auto c : MAGIC) {
+    magic_ok = magic_ok && r.u8() == static_cast<uint8_t>(c);
+  }
+
+  auto header_ok = magic_ok && r.uvar() == VERSION && r.u64() == key &&
+                   r.uvar() == data.size();
+  if (header_ok) {
+    auto sum = Digest();
+    r.bytes(sum.data(), sum.size());
+    header_ok = r.ok() && sum == digest(data);
+  }
+
+  if (header_ok) {
+    program = ast::cast<ast::Node, ast::Program>(decode(r));
+    if (!r.ok() || r.remaining() != 0) {
+      program = nullptr;
+    }
+    analysis::run(program);
+  }
+
+  ::munmap(mapping, size);
+  return program;
+}
+
+auto cache::store(const string &data,
+                  const std::shared_ptr<ast::Program> &program) -> void {
+  auto dir = directory();
+  if (!dir || !program) {
+    return;
+  }
+
+  std::error_code ec;
+  fs::create_directories(*dir, ec);
+  if (ec) {
+    return;
+  }
+
+  auto key = hash(data);
+  auto w = Writer();
+  w.bytes(MAGIC.data(), MAGIC.size());
+  w.uvar(VERSION);
+  w.u64(key);
+  w.uvar(data.size());
+  auto sum = digest(data);
+  w.bytes(sum.data(), sum.size());
+  encode(w, program);
+
+  // write next to the final file and rename over it, so a concurrent
+  // run (or module parsing thread) never maps a half written entry
+  auto file = file_path(*dir, key);
+  auto tmp = file;
+  tmp += std::format(".{}.{}", ::getpid(),
+                     std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+  {
+    auto out = std::ofstream(tmp, std::ios::binary | std::ios::trunc);
+    out.write(w.data().data(), w.data().size());
+    if (!out) {
+      fs::remove(tmp, ec);
+      return;
+    }
+  }
+
+  fs::rename(tmp, file, ec);
+  if (ec) {
+    fs::remove(tmp, ec);
+  }
+}
@@ -0,0 +1,80 @@
+#ifndef __ETA_CACHE_HPP__
+#define __ETA_CACHE_HPP__
+
+#include <array>
+#include <ast.hpp>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <types.hpp>
+
+using std::string;
+using std::string_view;
+
+namespace cache {
+// bump whenever the ast layout or the encoding below changes,
+// stale cache files are then ignored and rewritten
+const uint16_t VERSION = 5;
+
+class Writer {
+public:
+  auto u8(this Writer &self, uint8_t value) -> void;
+  auto u64(this Writer &self, uint64_t value) -> void;
+  auto uvar(this Writer &self, uint64_t value) -> void;
+  auto i64(this Writer &self, int64_t value) -> void;
+  auto f64(this Writer &self, double_t value) -> void;
+  auto str(this Writer &self, string_view value) -> void;
+  auto bytes(this Writer &self, const void *data, size_t size) -> void;
+  auto position(this Writer &self, const types::Position &pos) -> void;
+  auto data(this const Writer &self) -> const string &;
+
+private:
+  string buffer;
+};
+
+class Reader {
+public:
+  // positions read are marked with the given source
+  Reader(const char *data, size_t size,
+         uint32_t source = types::Position::RUNNING);
+  auto u8(this Reader &self) -> uint8_t;
+  auto u64(this Reader &self) -> uint64_t;
+  auto uvar(this Reader &self) -> uint64_t;
+  auto count(this Reader &self) -> size_t;
+  auto i64(this Reader &self) -> int64_t;
+  auto f64(this Reader &self) -> double_t;
+  auto str(this Reader &self) -> string;
+  auto bytes(this Reader &self, void *data, size_t size) -> void;
+  auto position(this Reader &self) -> types::Position;
+  auto remaining(this const Reader &self) -> size_t;
+  auto ok(this const Reader &self) -> bool;
+  auto fail(this Reader &self) -> void;
+
+private:
+  const char *data;
+  size_t size;
+  size_t cursor;
+  bool error;
+  uint32_t source;
+};
+
+auto encode(Writer &w, const std::shared_ptr<ast::Node> &node) -> void;
+auto decode(Reader &r) -> std::shared_ptr<ast::Node>;
+
+// the hash names the cache file, the digest and the source length in
+// its header tell apart two sources that share a name
+using Digest = std::array<uint8_t, 32>;
+
+auto hash(string_view data) -> uint64_t;
+auto digest(string_view data) -> Digest;
+// positions of the program are marked with the given source
+auto load(const string &data, uint32_t source)
+    -> std::shared_ptr<ast::Program>;
+auto store(const string &data, const std::shared_ptr<ast::Program> &program)
+    -> void;
+}; // namespace cache
+
+#endif
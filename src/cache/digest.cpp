@@ -0,0 +1,102 @@
+#include <array>
+#include <bit>
+#include <cache.hpp>
+#include <cstring>
+
+// SHA-256, FIPS 180-4
+static const std::array<uint32_t, 64> K = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static auto compress(std::array<uint32_t, 8> &state, const uint8_t *block)
+    -> void {
+  uint32_t w[64];
+  for (size_t i = 0; i < 16; i++) {
+    w[i] = static_cast<uint32_t>(block[i * 4]) << 24 |
+           static_cast<uint32_t>(block[i * 4 + 1]) << 16 |
+           static_cast<uint32_t>(block[i * 4 + 2]) << 8 |
+           static_cast<uint32_t>(block[i * 4 + 3]);
+  }
+  for (size_t i = 16; i < 64; i++) {
+    auto s0 = std::rotr(w[i - 15], 7) ^ std::rotr(w[i - 15], 18) ^
+              (w[i - 15] >> 3);
+    auto s1 = std::rotr(w[i - 2], 17) ^ std::rotr(w[i - 2], 19) ^
+              (w[i - 2] >> 10);
+    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+  }
+
+  auto [a, b, c, d, e, f, g, h] = state;
+  for (size_t i = 0; i < 64; i++) {
+    auto s1 = std::rotr(e, 6) ^ std::rotr(e, 11) ^ std::rotr(e, 25);
+    auto ch = (e & f) ^ (~e & g);
+    auto t1 = h + s1 + ch + K[i] + w[i];
+    auto s0 = std::rotr(a, 2) ^ std::rotr(a, 13) ^ std::rotr(a, 22);
+    auto maj = (a & b) ^ (a & c) ^ (b & c);
+    auto t2 = s0 + maj;
+    h = g;
+    g = f;
+    f = e;
+    e = d + t1;
+    d = c;
+    c = b;
+    b = a;
+    a = t1 + t2;
+  }
+
+  state[0] += a;
+  state[1] += b;
+  state[2] += c;
+  state[3] += d;
+  state[4] += e;
+  state[5] += f;
+  state[6] += g;
+  state[7] += h;
+}
+
+auto cache::digest(string_view data) -> Digest {
+  auto state = std::array<uint32_t, 8>{
+      0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+      0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+  };
+
+  auto bytes = reinterpret_cast<const uint8_t *>(data.data());
+  auto size = data.size();
+  size_t i = 0;
+  for (; i + 64 <= size; i += 64) {
+    compress(state, bytes + i);
+  }
+
+  // the tail, a one bit, zeros and the length in bits fill the last
+  // one or two blocks
+  uint8_t tail[128] = {};
+  auto rest = size - i;
+  std::memcpy(tail, bytes + i, rest);
+  tail[rest] = 0x80;
+  auto blocks = rest + 9 > 64 ? 2 : 1;
+  auto bits = static_cast<uint64_t>(size) * 8;
+  for (size_t j = 0; j < 8; j++) {
+    tail[blocks * 64 - 1 - j] = static_cast<uint8_t>(bits >> (j * 8));
+  }
+  for (size_t j = 0; j < blocks; j++) {
+    compress(state, tail + j * 64);
+  }
+
+  auto res = Digest();
+  for (size_t j = 0; j < 8; j++) {
+    res[j * 4] = static_cast<uint8_t>(state[j] >> 24);
+    res[j * 4 + 1] = static_cast<uint8_t>(state[j] >> 16);
+    res[j * 4 + 2] = static_cast<uint8_t>(state[j] >> 8);
+    res[j * 4 + 3] = static_cast<uint8_t>(state[j]);
+  }
+  return res;
+}
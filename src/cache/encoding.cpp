@@ -0,0 +1,606 @@
+#include <ast.hpp>
+#include <cache.hpp>
+#include <cstring>
+#include <memory>
+#include <token.hpp>
+
+using namespace ast;
+using cache::Reader;
+using cache::Writer;
+
+static const uint8_t NIL = 0xff;
+
+// ---------------------------------------
+// WRITER
+auto Writer::u8(this Writer &self, uint8_t value) -> void {
+  self.buffer.push_back(static_cast<char>(value));
+}
+
+auto Writer::u64(this Writer &self, uint64_t value) -> void {
+  self.bytes(&value, sizeof(value));
+}
+
+auto Writer::uvar(this Writer &self, uint64_t value) -> void {
+  while (value >= 0x80) {
+    self.u8(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  self.u8(static_cast<uint8_t>(value));
+}
+
+auto Writer::i64(this Writer &self, int64_t value) -> void {
+  self.bytes(&value, sizeof(value));
+}
+
+auto Writer::f64(this Writer &self, double_t value) -> void {
+  self.bytes(&value, sizeof(value));
+}
+
+auto Writer::str(this Writer &self, string_view value) -> void {
+  self.uvar(value.size());
+  self.buffer.append(value);
+}
+
+auto Writer::bytes(this Writer &self, const void *data, size_t size) -> void {
+  self.buffer.append(static_cast<const char *>(data), size);
+}
+
+auto Writer::position(this Writer &self, const types::Position &pos) -> void {
+  self.uvar(pos.cursor);
+  self.uvar(pos.row);
+  self.uvar(pos.linebeg);
+}
+
+auto Writer::data(this const Writer &self) -> const string & {
+  return self.buffer;
+}
+
+// ---------------------------------------
+// READER
+Reader::Reader(const char *data, size_t size, uint32_t source)
+    : data(data), size(size), cursor(0), error(false), source(source) {}
+
+auto Reader::u8(this Reader &self) -> uint8_t {
+  if (self.error || self.cursor >= self.size) {
+    self.error = true;
+    return 0;
+  }
+
+  return static_cast<uint8_t>(self.data[self.cursor++]);
+}
+
+auto Reader::u64(this Reader &self) -> uint64_t {
+  uint64_t value = 0;
+  self.bytes(&value, sizeof(value));
+  return value;
+}
+
+auto Reader::uvar(this Reader &self) -> uint64_t {
+  uint64_t value = 0;
+  for (uint32_t shift = 0; shift < 64; shift += 7) {
+    auto byte = self.u8();
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      return value;
+    }
+  }
+
+  self.error = true;
+  return 0;
+}
+
+auto Reader::count(this Reader &self) -> size_t {
+  // every encoded element takes at least one byte, anything
+  // larger than what is left can only come from a corrupt file
+  auto value = self.uvar();
+  if (value > self.remaining()) {
+    self.error = true;
+    return 0;
+  }
+
+  return value;
+}
+
+auto Reader::i64(this Reader &self) -> int64_t {
+  int64_t value = 0;
+  self.bytes(&value, sizeof(value));
+  return value;
+}
+
+auto Reader::f64(this Reader &self) -> double_t {
+  double_t value = 0;
+  self.bytes(&value, sizeof(value));
+  return value;
+}
+
+auto Reader::str(this Reader &self) -> string {
+  auto length = self.count();
+  if (self.error) {
+    return {};
+  }
+
+  auto res = string(self.data + self.cursor, length);
+  self.cursor += length;
+  return res;
+}
+
+auto Reader::bytes(this Reader &self, void *data, size_t size) -> void {
+  if (self.error || size > self.remaining()) {
+    self.error = true;
+    return;
+  }
+
+  std::memcpy(data, self.data + self.cursor, size);
+  self.cursor += size;
+}
+
+auto Reader::position(this Reader &self) -> types::Position {
+  auto pos = types::Position();
+  pos.cursor = self.uvar();
+  pos.row = self.uvar();
+  pos.linebeg = self.uvar();
+  pos.source = self.source;
+  return pos;
+}
+
+auto Reader::remaining(this const Reader &self) -> size_t {
+  return self.size - self.cursor;
+}
+
+auto Reader::ok(this const Reader &self) -> bool { return !self.error; }
+
+auto Reader::fail(this Reader &self) -> void { self.error = true; }
+
+// ---------------------------------------
+// AST ENCODING
+auto cache::encode(Writer &w, const std::shared_ptr<Node> &node) -> void {
+  if (!node) {
+    w.u8(NIL);
+    return;
+  }
+
+  w.u8(node->type());
+  switch (node->type()) {
+  case ASTType::PROGRAM: {
+    auto prgm = ast::cast<Node, Program>(node);
+    w.uvar(prgm->statements.size());
+    for (const auto &stmt : prgm->statements) {
+      encode(w, stmt);
+    }
+    break;
+  }
+
+  case ASTType::BLOCK: {
+    auto blk = ast::cast<Node, BlockStatement>(node);
+    w.position(blk->pos);
+    w.uvar(blk->statements.size());
+    for (const auto &stmt : blk->statements) {
+      encode(w, stmt);
+    }
+    break;
+  }
+
+  case ASTType::IDENTIFIER: {
+    auto expr = ast::cast<Node, Identifier>(node);
+    w.position(expr->pos);
+    w.str(expr->value);
+    break;
+  }
+
+  case ASTType::FUNCTION: {
+    auto expr = ast::cast<Node, FunctionLiteral>(node);
+    w.position(expr->pos);
+    w.uvar(expr->parameters.size());
+    for (const auto &parm : expr->parameters) {
+      encode(w, parm);
+    }
+    encode(w, expr->body);
+    break;
+  }
+
+  case ASTType::INTEGER: {
+    auto expr = ast::cast<Node, IntegerLiteral>(node);
+    w.position(expr->pos);
+    w.i64(expr->value);
+    break;
+  }
+
+  case ASTType::FLOAT: {
+    auto expr = ast::cast<Node, FloatLiteral>(node);
+    w.position(expr->pos);
+    w.f64(expr->value);
+    break;
+  }
+
+  case ASTType::BOOL: {
+    auto expr = ast::cast<Node, BoolLiteral>(node);
+    w.position(expr->pos);
+    w.u8(expr->value);
+    break;
+  }
+
+  case ASTType::STRING: {
+    auto expr = ast::cast<Node, StringLiteral>(node);
+    w.position(expr->pos);
+    w.str(expr->value);
+    break;
+  }
+
+  case ASTType::ARRAY: {
+    auto expr = ast::cast<Node, ArrayLiteral>(node);
+    w.position(expr->pos);
+    w.uvar(expr->elements.size());
+    for (const auto &e : expr->elements) {
+      encode(w, e);
+    }
+    break;
+  }
+
+  case ASTType::DICT: {
+    auto expr = ast::cast<Node, DictLiteral>(node);
+    w.position(expr->pos);
+    w.uvar(expr->pairs.size());
+    for (const auto &[key, value] : expr->pairs) {
+      encode(w, key);
+      encode(w, value);
+    }
+    break;
+  }
+
+  case ASTType::PREFIX: {
+    auto expr = ast::cast<Node, PrefixExpression>(node);
+    w.position(expr->pos);
+    w.u8(expr->op);
+    encode(w, expr->right);
+    break;
+  }
+
+  case ASTType::INFIX: {
+    auto expr = ast::cast<Node, InfixExpression>(node);
+    w.position(expr->pos);
+    w.u8(expr->op);
+    encode(w, expr->left);
+    encode(w, expr->right);
+    break;
+  }
+
+  case ASTType::IF: {
+    auto expr = ast::cast<Node, IfExpression>(node);
+    w.position(expr->pos);
+    encode(w, expr->condition);
+    encode(w, expr->consequence);
+    encode(w, expr->alternative);
+    break;
+  }
+
+  case ASTType::FOR: {
+    auto expr = ast::cast<Node, ForExpression>(node);
+    w.position(expr->pos);
+    encode(w, expr->intialization);
+    encode(w, expr->condition);
+    encode(w, expr->updation);
+    encode(w, expr->body);
+    break;
+  }
+
+  case ASTType::FORIN: {
+    auto expr = ast::cast<Node, ForInExpression>(node);
+    w.position(expr->pos);
+    encode(w, expr->name);
+    encode(w, expr->iterable);
+    encode(w, expr->body);
+    break;
+  }
+
+  case ASTType::ASSIGNMENT: {
+    auto expr = ast::cast<Node, AssignmentExpression>(node);
+    w.position(expr->pos);
+    encode(w, expr->name);
+    encode(w, expr->value);
+    break;
+  }
+
+  case ASTType::CALL: {
+    auto expr = ast::cast<Node, CallExpression>(node);
+    w.position(expr->pos);
+    encode(w, expr->function);
+    w.uvar(expr->arguments.size());
+    for (const auto &a : expr->arguments) {
+      encode(w, a);
+    }
+    break;
+  }
+
+  case ASTType::INDEX: {
+    auto expr = ast::cast<Node, IndexExpression>(node);
+    w.position(expr->pos);
+    encode(w, expr->left);
+    encode(w, expr->index);
+    break;
+  }
+
+  case ASTType::OPASSIGNMENT: {
+    auto expr = ast::cast<Node, OpAssignment>(node);
+    w.position(expr->pos);
+    w.u8(expr->op);
+    encode(w, expr->name);
+    encode(w, expr->value);
+    break;
+  }
+
+  case ASTType::LET: {
+    auto stmt = ast::cast<Node, LetStatement>(node);
+    w.position(stmt->pos);
+    encode(w, stmt->name);
+    encode(w, stmt->value);
+    break;
+  }
+
+  case ASTType::RETURN: {
+    auto stmt = ast::cast<Node, ReturnStatement>(node);
+    w.position(stmt->pos);
+    encode(w, stmt->value);
+    break;
+  }
+
+  case ASTType::EXPRESSION: {
+    auto stmt = ast::cast<Node, ExpressionStatement>(node);
+    w.position(stmt->pos);
+    encode(w, stmt->expression);
+    break;
+  }
+
+  case ASTType::IMPORT: {
+    auto stmt = ast::cast<Node, ImportStatement>(node);
+    w.position(stmt->pos);
+    w.str(stmt->path);
+    break;
+  }
+  }
+}
+
+// ---------------------------------------
+// AST DECODING
+template <typename T> static auto decode_as(Reader &r) -> std::shared_ptr<T> {
+  auto node = cache::decode(r);
+  if (!node) {
+    return nullptr;
+  }
+
+  auto res = ast::cast<Node, T>(std::move(node));
+  if (!res) {
+    r.fail();
+  }
+  return res;
+}
+
+// a child the evaluator always dereferences, a null one means the payload
+// is corrupt
+template <typename T>
+static auto decode_required(Reader &r) -> std::shared_ptr<T> {
+  auto res = decode_as<T>(r);
+  if (!res) {
+    r.fail();
+  }
+  return res;
+}
+
+static auto decode_op(Reader &r) -> token::Token {
+  auto op = r.u8();
+  if (op >= token::Token::__TOKENCOUNT__) {
+    r.fail();
+    return token::Token::TNONE;
+  }
+
+  return static_cast<token::Token>(op);
+}
+
+auto cache::decode(Reader &r) -> std::shared_ptr<Node> {
+  auto tag = r.u8();
+  if (!r.ok() || tag == NIL) {
+    return nullptr;
+  }
+
+  switch (tag) {
+  case ASTType::PROGRAM: {
+    auto res = std::make_shared<Program>();
+    auto count = r.count();
+    for (size_t i = 0; i < count && r.ok(); i++) {
+      res->statements.push_back(decode_required<Statement>(r));
+    }
+    return res;
+  }
+
+  case ASTType::BLOCK: {
+    auto res = std::make_shared<BlockStatement>();
+    res->pos = r.position();
+    auto count = r.count();
+    for (size_t i = 0; i < count && r.ok(); i++) {
+      res->statements.push_back(decode_required<Statement>(r));
+    }
+    return res;
+  }
+
+  case ASTType::IDENTIFIER: {
+    auto res = std::make_shared<Identifier>();
+    res->pos = r.position();
+    res->value = r.str();
+    return res;
+  }
+
+  case ASTType::FUNCTION: {
+    auto res = std::make_shared<FunctionLiteral>();
+    res->pos = r.position();
+    auto count = r.count();
+    for (size_t i = 0; i < count && r.ok(); i++) {
+      res->parameters.push_back(decode_required<Identifier>(r));
+    }
+    res->body = decode_required<BlockStatement>(r);
+    return res;
+  }
+
+  case ASTType::INTEGER: {
+    auto res = std::make_shared<IntegerLiteral>();
+    res->pos = r.position();
+    res->value = r.i64();
+    return res;
+  }
+
+  case ASTType::FLOAT: {
+    auto res = std::make_shared<FloatLiteral>();
+    res->pos = r.position();
+    res->value = r.f64();
+    return res;
+  }
+
+  case ASTType::BOOL: {
+    auto res = std::make_shared<BoolLiteral>();
+    res->pos = r.position();
+    res->value = r.u8() != 0;
+    return res;
+  }
+
+  case ASTType::STRING: {
+    auto res = std::make_shared<StringLiteral>();
+    res->pos = r.position();
+    res->value = r.str();
+    return res;
+  }
+
+  case ASTType::ARRAY: {
+    auto res = std::make_shared<ArrayLiteral>();
+    res->pos = r.position();
+    auto count = r.count();
+    for (size_t i = 0; i < count && r.ok(); i++) {
+      res->elements.push_back(decode_required<Expression>(r));
+    }
+    return res;
+  }
+
+  case ASTType::DICT: {
+    auto res = std::make_shared<DictLiteral>();
+    res->pos = r.position();
+    auto count = r.count();
+    for (size_t i = 0; i < count && r.ok(); i++) {
+      auto key = decode_required<Expression>(r);
+      auto value = decode_required<Expression>(r);
+      res->pairs.emplace_back(std::move(key), std::move(value));
+    }
+    return res;
+  }
+
+  case ASTType::PREFIX: {
+    auto res = std::make_shared<PrefixExpression>();
+    res->pos = r.position();
+    res->op = decode_op(r);
+    res->right = decode_required<Expression>(r);
+    return res;
+  }
+
+  case ASTType::INFIX: {
+    auto res = std::make_shared<InfixExpression>();
+    res->pos = r.position();
+    res->op = decode_op(r);
+    res->left = decode_required<Expression>(r);
+    res->right = decode_required<Expression>(r);
+    return res;
+  }
+
+  case ASTType::IF: {
+    auto res = std::make_shared<IfExpression>();
+    res->pos = r.position();
+    res->condition = decode_required<Expression>(r);
+    res->consequence = decode_required<BlockStatement>(r);
+    res->alternative = decode_as<BlockStatement>(r);
+    return res;
+  }
+
+  case ASTType::FOR: {
+    auto res = std::make_shared<ForExpression>();
+    res->pos = r.position();
+    res->intialization = decode_as<LetStatement>(r);
+    res->condition = decode_as<Expression>(r);
+    res->updation = decode_as<Expression>(r);
+    res->body = decode_required<BlockStatement>(r);
+    return res;
+  }
+
+  case ASTType::FORIN: {
+    auto res = std::make_shared<ForInExpression>();
+    res->pos = r.position();
+    res->name = decode_required<Identifier>(r);
+    res->iterable = decode_required<Expression>(r);
+    res->body = decode_required<BlockStatement>(r);
+    return res;
+  }
+
+  case ASTType::ASSIGNMENT: {
+    auto res = std::make_shared<AssignmentExpression>();
+    res->pos = r.position();
+    res->name = decode_required<Expression>(r);
+    res->value = decode_required<Expression>(r);
+    return res;
+  }
+
+  case ASTType::CALL: {
+    auto res = std::make_shared<CallExpression>();
+    res->pos = r.position();
+    res->function = decode_required<Expression>(r);
+    auto count = r.count();
+    for (size_t i = 0; i < count && r.ok(); i++) {
+      res->arguments.push_back(decode_required<Expression>(r));
+    }
+    return res;
+  }
+
+  case ASTType::INDEX: {
+    auto res = std::make_shared<IndexExpression>();
+    res->pos = r.position();
+    res->left = decode_required<Expression>(r);
+    res->index = decode_required<Expression>(r);
+    return res;
+  }
+
+  case ASTType::OPASSIGNMENT: {
+    auto res = std::make_shared<OpAssignment>();
+    res->pos = r.position();
+    res->op = decode_op(r);
+    res->name = decode_required<Expression>(r);
+    res->value = decode_required<Expression>(r);
+    return res;
+  }
+
+  case ASTType::LET: {
+    auto res = std::make_shared<LetStatement>();
+    res->pos = r.position();
+    res->name = decode_required<Identifier>(r);
+    res->value = decode_required<Expression>(r);
+    return res;
+  }
+
+  case ASTType::RETURN: {
+    auto res = std::make_shared<ReturnStatement>();
+    res->pos = r.position();
+    res->value = decode_as<Expression>(r);
+    return res;
+  }
+
+  case ASTType::EXPRESSION: {
+    auto res = std::make_shared<ExpressionStatement>();
+    res->pos = r.position();
+    res->expression = decode_required<Expression>(r);
+    return res;
+  }
+
+  case ASTType::IMPORT: {
+    auto res = std::make_shared<ImportStatement>();
+    res->pos = r.position();
+    res->path = r.str();
+    return res;
+  }
+
+  default:
+    r.fail();
+    return nullptr;
+  }
+}
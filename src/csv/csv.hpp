@@ -0,0 +1,90 @@
+#ifndef __ETA_CSV_HPP__
+#define __ETA_CSV_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <fstream>
+#include <kernels.hpp>
+#include <memory>
+#include <object.hpp>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using std::string;
+using std::string_view;
+
+// comma separated files as in rfc 4180: fields may be quoted, a quoted
+// field may hold delimiters, newlines and doubled quotes, rows end with
+// \n or \r\n and blank lines are skipped
+namespace csv {
+// the field as an int or a float when all of it parses as one, as a
+// string otherwise
+auto field(string_view text) -> std::shared_ptr<object::Object>;
+
+// rows of a file one at a time. the file is read in chunks, a row cut
+// off by the end of the buffer is split again once more of it is in
+class Reader {
+public:
+  static constexpr size_t CHUNK = 1 << 20;
+
+  static auto open(const string &path, char delimiter = ',')
+      -> std::expected<Reader, string>;
+  // keeps only the fields at these indexes of every following row, in
+  // this order. the other fields are stepped over without being stored
+  auto project(this Reader &self, const std::vector<size_t> &columns)
+      -> void;
+  // reads the first row as the column names and keeps the named columns,
+  // or all of them when names is empty. returns the kept names
+  auto header(this Reader &self, const std::vector<string> &names)
+      -> std::expected<std::vector<string>, string>;
+  // the fields of the next row, false once the file is over. the views
+  // point into the reader and stay valid until the next call
+  auto next(this Reader &self, std::vector<string_view> &fields)
+      -> std::expected<bool, string>;
+
+private:
+  struct Span {
+    size_t start;
+    size_t end;
+    // a quoted field holding doubled quotes
+    bool escaped;
+  };
+
+  Reader(std::ifstream file, char delimiter);
+  // the end of the row starting at pos, nullopt when the buffer ends
+  // before the row does
+  auto split(this Reader &self)
+      -> std::expected<std::optional<size_t>, string>;
+  auto fill(this Reader &self) -> void;
+
+  std::ifstream file;
+  string buffer;
+  size_t pos;
+  bool eof;
+  size_t row;
+
+  char delimiter;
+  kernels::Scanner plain;
+  kernels::Scanner quoted;
+
+  // where each column goes in a row, -1 for skipped columns, empty
+  // when every field is kept
+  std::vector<int64_t> slots;
+  size_t width;
+  std::vector<Span> spans;
+};
+
+// the columns of a file whose first row names them, as a dict from name
+// to array. a column of ints becomes a packed int array, a column of
+// ints and floats a packed float array, any other column holds each
+// field as field() reads it. names picks and orders the columns, all
+// of them are read when it is empty
+auto read(const string &path, const std::vector<string> &names,
+          char delimiter = ',')
+    -> std::expected<std::shared_ptr<object::Dict>, string>;
+}; // namespace csv
+
+#endif
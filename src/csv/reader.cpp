@@ -0,0 +1,220 @@
+#include <algorithm>
+#include <csv.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <format>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+static const size_t NPOS = string_view::npos;
+
+csv::Reader::Reader(std::ifstream file, char delimiter)
+    : file(std::move(file)), pos(0), eof(false), row(0),
+      delimiter(delimiter), plain(string{delimiter, '\n'}), quoted("\""),
+      width(0) {}
+
+auto csv::Reader::open(const string &path, char delimiter)
+    -> std::expected<Reader, string> {
+  auto file = std::ifstream(path, std::ios::binary);
+  if (!file) {
+    return std::unexpected(std::format("cannot open file: {}", path));
+  }
+  return Reader(std::move(file), delimiter);
+}
+
+auto csv::Reader::project(this Reader &self,
+                          const std::vector<size_t> &columns) -> void {
+  self.slots.clear();
+  self.width = columns.size();
+  for (size_t i = 0; i < columns.size(); i++) {
+    if (columns[i] >= self.slots.size()) {
+      self.slots.resize(columns[i] + 1, -1);
+    }
+    self.slots[columns[i]] = static_cast<int64_t>(i);
+  }
+}
+
+auto csv::Reader::header(this Reader &self, const std::vector<string> &names)
+    -> std::expected<std::vector<string>, string> {
+  auto fields = std::vector<string_view>();
+  auto res = self.next(fields);
+  if (!res.has_value()) {
+    return std::unexpected(res.error());
+  }
+  if (!res.value()) {
+    return std::unexpected("csv file has no header");
+  }
+
+  auto all = std::vector<string>(fields.begin(), fields.end());
+  auto kept = names.empty() ? all : names;
+  auto columns = std::vector<size_t>();
+  for (const auto &name : kept) {
+    auto it = std::ranges::find(all, name);
+    if (it == all.end()) {
+      return std::unexpected(std::format("no column named {}", name));
+    }
+    if (std::ranges::count(kept, name) > 1) {
+      return std::unexpected(std::format("column {} appears twice", name));
+    }
+    columns.push_back(static_cast<size_t>(it - all.begin()));
+  }
+
+  self.project(columns);
+  return kept;
+}
+
+auto csv::Reader::next(this Reader &self, std::vector<string_view> &fields)
+    -> std::expected<bool, string> {
+  size_t end;
+  for (;;) {
+    while (self.pos < self.buffer.size() &&
+           (self.buffer[self.pos] == '\n' || self.buffer[self.pos] == '\r')) {
+      self.pos++;
+    }
+    if (self.pos == self.buffer.size()) {
+      if (self.eof) {
+        return false;
+      }
+      self.fill();
+      continue;
+    }
+
+    auto res = self.split();
+    if (!res.has_value()) {
+      return std::unexpected(res.error());
+    }
+    if (res->has_value()) {
+      end = res->value();
+      break;
+    }
+    self.fill();
+  }
+
+  self.row++;
+  fields.resize(self.spans.size());
+  for (size_t i = 0; i < self.spans.size(); i++) {
+    auto &span = self.spans[i];
+    if (span.start == NPOS) {
+      return std::unexpected(
+          std::format("row {} has too few fields", self.row));
+    }
+
+    // doubled quotes are undone in place, the row is never split again
+    if (span.escaped) {
+      auto w = span.start;
+      for (auto r = span.start; r < span.end; r++, w++) {
+        self.buffer[w] = self.buffer[r];
+        if (self.buffer[r] == '"') {
+          r++;
+        }
+      }
+      span.end = w;
+    }
+    fields[i] =
+        string_view(self.buffer).substr(span.start, span.end - span.start);
+  }
+  self.pos = end;
+  return true;
+}
+
+// fields are found with the simd scanner, up to the next delimiter or
+// newline outside quotes and up to the next quote inside them
+auto csv::Reader::split(this Reader &self)
+    -> std::expected<std::optional<size_t>, string> {
+  auto text = string_view(self.buffer);
+  auto projected = !self.slots.empty();
+  self.spans.clear();
+  if (projected) {
+    self.spans.assign(self.width, Span{NPOS, NPOS, false});
+  }
+
+  auto i = self.pos;
+  for (size_t col = 0;; col++) {
+    auto span = Span{i, i, false};
+    if (i < text.size() && text[i] == '"') {
+      auto from = i + 1;
+      for (;;) {
+        auto q = self.quoted.find(text, from);
+        if (q == NPOS && self.eof) {
+          return std::unexpected(std::format(
+              "unterminated quoted field in row {}", self.row + 1));
+        }
+        if (q == NPOS || (q + 1 == text.size() && !self.eof)) {
+          return std::nullopt;
+        }
+        if (q + 1 < text.size() && text[q + 1] == '"') {
+          span.escaped = true;
+          from = q + 2;
+          continue;
+        }
+        span.start = i + 1;
+        span.end = q;
+        i = q + 1;
+        break;
+      }
+
+      if (i < text.size() && text[i] == '\r') {
+        i++;
+      }
+      if (i < text.size() && text[i] != self.delimiter && text[i] != '\n') {
+        return std::unexpected(std::format(
+            "unexpected character after a quoted field in row {}",
+            self.row + 1));
+      }
+    } else {
+      auto k = self.plain.find(text, i);
+      if (k == NPOS) {
+        if (!self.eof) {
+          return std::nullopt;
+        }
+        k = text.size();
+      }
+      span.end = k;
+      if (span.end > span.start && text[span.end - 1] == '\r' &&
+          (k == text.size() || text[k] == '\n')) {
+        span.end--;
+      }
+      i = k;
+    }
+
+    if (!projected) {
+      self.spans.push_back(span);
+    } else if (col < self.slots.size() && self.slots[col] >= 0) {
+      self.spans[self.slots[col]] = span;
+    }
+
+    if (i >= text.size()) {
+      if (!self.eof) {
+        return std::nullopt;
+      }
+      return i;
+    }
+    if (text[i] == '\n') {
+      return i + 1;
+    }
+    i++;
+  }
+}
+
+// drops the rows already read and reads at least a chunk, as much as
+// the buffer already holds when a row spans several chunks so the
+// splitting stays linear
+auto csv::Reader::fill(this Reader &self) -> void {
+  self.buffer.erase(0, self.pos);
+  self.pos = 0;
+
+  auto size = self.buffer.size();
+  auto want = std::max(CHUNK, size);
+  self.buffer.resize(size + want);
+  self.file.read(self.buffer.data() + size, want);
+  auto got = static_cast<size_t>(self.file.gcount());
+  self.buffer.resize(size + got);
+  if (got < want) {
+    self.eof = true;
+  }
+}
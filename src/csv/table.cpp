@@ -0,0 +1,145 @@
+#include <charconv>
+#include <csv.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <object.hpp>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+using namespace object;
+
+namespace {
+auto integer(string_view text) -> std::optional<int64_t> {
+  int64_t value;
+  auto end = text.data() + text.size();
+  auto [ptr, ec] = std::from_chars(text.data(), end, value);
+  if (ec != std::errc() || ptr != end) {
+    return std::nullopt;
+  }
+  return value;
+}
+
+auto number(string_view text) -> std::optional<double> {
+  double value;
+  auto end = text.data() + text.size();
+  auto [ptr, ec] = std::from_chars(text.data(), end, value);
+  if (ec != std::errc() || ptr != end) {
+    return std::nullopt;
+  }
+  return value;
+}
+
+// fields of one column parsed as they arrive. the column stays packed
+// ints while every field is an int, turns into packed floats at the
+// first other number and into boxed fields at the first non number
+class Column {
+public:
+  auto push(this Column &self, string_view text) -> void {
+    switch (self.kind) {
+    case Kind::INTS:
+      if (auto value = integer(text)) {
+        self.ints.push_back(*value);
+        return;
+      }
+      if (auto value = number(text)) {
+        self.floats.assign(self.ints.begin(), self.ints.end());
+        self.floats.push_back(*value);
+        self.ints = {};
+        self.kind = Kind::FLOATS;
+        return;
+      }
+      self.boxed.reserve(self.ints.size() + 1);
+      for (auto value : self.ints) {
+        self.boxed.push_back(std::make_shared<Integer>(value));
+      }
+      self.ints = {};
+      self.kind = Kind::BOXED;
+      break;
+
+    case Kind::FLOATS:
+      if (auto value = number(text)) {
+        self.floats.push_back(*value);
+        return;
+      }
+      self.boxed.reserve(self.floats.size() + 1);
+      for (auto value : self.floats) {
+        self.boxed.push_back(std::make_shared<Float>(value));
+      }
+      self.floats = {};
+      self.kind = Kind::BOXED;
+      break;
+
+    case Kind::BOXED:
+      break;
+    }
+    self.boxed.push_back(csv::field(text));
+  }
+
+  auto array(this Column &self) -> std::shared_ptr<Array> {
+    switch (self.kind) {
+    case Kind::INTS:
+      return std::make_shared<Array>(std::move(self.ints));
+    case Kind::FLOATS:
+      return std::make_shared<Array>(std::move(self.floats));
+    default:
+      return std::make_shared<Array>(std::move(self.boxed));
+    }
+  }
+
+private:
+  enum class Kind { INTS, FLOATS, BOXED };
+
+  Kind kind = Kind::INTS;
+  Array::Ints ints;
+  Array::Floats floats;
+  Array::Boxed boxed;
+};
+}; // namespace
+
+auto csv::field(string_view text) -> std::shared_ptr<Object> {
+  if (auto value = integer(text)) {
+    return std::make_shared<Integer>(*value);
+  }
+  if (auto value = number(text)) {
+    return std::make_shared<Float>(*value);
+  }
+  return std::make_shared<String>(string(text));
+}
+
+auto csv::read(const string &path, const std::vector<string> &names,
+               char delimiter) -> std::expected<std::shared_ptr<Dict>, string> {
+  auto reader = Reader::open(path, delimiter);
+  if (!reader.has_value()) {
+    return std::unexpected(reader.error());
+  }
+  auto header = reader->header(names);
+  if (!header.has_value()) {
+    return std::unexpected(header.error());
+  }
+
+  auto columns = std::vector<Column>(header->size());
+  auto fields = std::vector<string_view>();
+  for (;;) {
+    auto res = reader->next(fields);
+    if (!res.has_value()) {
+      return std::unexpected(res.error());
+    }
+    if (!res.value()) {
+      break;
+    }
+    for (size_t i = 0; i < columns.size(); i++) {
+      columns[i].push(fields[i]);
+    }
+  }
+
+  auto res = std::make_shared<Dict>();
+  for (size_t i = 0; i < columns.size(); i++) {
+    res->set(std::make_shared<String>((*header)[i]), columns[i].array());
+  }
+  return res;
+}
@@ -37,6 +37,12 @@ auto Eval::declare(this Eval &self, std::shared_ptr<LetStatement> node,
                        self.serror("a function with same name already exists"));
   }
 
+  // lets a function literal capture the variable it is bound to,
+  // recursive functions refer to themselves through this slot
+  if (node->value && node->value->type() == ASTType::FUNCTION) {
+    env->reserve(node->name->value);
+  }
+
   auto res = self.eval(node->value, env);
   if (is_error(res)) {
     return res;
@@ -94,7 +100,7 @@ auto Eval::assignement_array(this Eval &self,
   }
 
   auto i = object::cast<Object, Integer>(std::move(idx))->value;
-  if (i < 0 || (size_t)i >= array->elements.size()) {
+  if (i < 0 || (size_t)i >= array->size()) {
     return self.derror(idx_pos, self.serror("index out of range"));
   }
 
@@ -104,7 +110,7 @@ auto Eval::assignement_array(this Eval &self,
     return err;
   }
 
-  array->elements[i] = std::move(val);
+  array->set(i, std::move(val));
   return array;
 }
 
@@ -125,7 +131,7 @@ auto Eval::assignement_string(this Eval &self,
   }
 
   auto i = object::cast<Object, Integer>(std::move(idx))->value;
-  if (i < 0 || (size_t)i >= string->value.length()) {
+  if (i < 0 || (size_t)i >= string->size()) {
     return self.derror(idx_pos, self.serror("index out of range"));
   }
 
@@ -140,10 +146,139 @@ auto Eval::assignement_string(this Eval &self,
   }
 
   // [TODO] checking for length on RHS string and ""
-  string->value[i] = object::cast<Object, String>(val)->value[0];
+  auto rhs = object::cast<Object, String>(val)->view();
+  string->set(i, rhs.empty() ? '\0' : rhs[0]);
   return string;
 }
 
+auto Eval::assignement_deque(this Eval &self,
+                             const std::shared_ptr<Deque> deque,
+                             std::shared_ptr<Expression> index,
+                             std::shared_ptr<Expression> value,
+                             std::shared_ptr<Environment> &env)
+    -> const std::shared_ptr<Object> {
+  auto idx_pos = index->position();
+  auto idx = self.eval(std::move(index), env);
+  if (auto err = self.error(idx_pos, idx); is_error(err)) {
+    return err;
+  }
+
+  if (idx->type() != ObjectType::OINT) {
+    return self.derror(idx_pos, self.serror("expected an int type for index"));
+  }
+
+  auto val_pos = value->position();
+  auto val = self.eval(std::move(value), env);
+  if (auto err = self.error(val_pos, val); is_error(err)) {
+    return err;
+  }
+
+  // the value may have pushed or popped, check the index against now
+  auto i = object::cast<Object, Integer>(std::move(idx))->value;
+  if (i < 0 || (size_t)i >= deque->size()) {
+    return self.derror(idx_pos, self.serror("index out of range"));
+  }
+
+  deque->set(i, std::move(val));
+  return deque;
+}
+
+auto Eval::assignement_bitset(this Eval &self,
+                              const std::shared_ptr<Bitset> bitset,
+                              std::shared_ptr<Expression> index,
+                              std::shared_ptr<Expression> value,
+                              std::shared_ptr<Environment> &env)
+    -> const std::shared_ptr<Object> {
+  auto idx_pos = index->position();
+  auto idx = self.eval(std::move(index), env);
+  if (auto err = self.error(idx_pos, idx); is_error(err)) {
+    return err;
+  }
+
+  if (idx->type() != ObjectType::OINT) {
+    return self.derror(idx_pos, self.serror("expected an int type for index"));
+  }
+
+  auto i = object::cast<Object, Integer>(std::move(idx))->value;
+  if (i < 0 || (size_t)i >= bitset->size()) {
+    return self.derror(idx_pos, self.serror("index out of range"));
+  }
+
+  auto val_pos = value->position();
+  auto val = self.eval(std::move(value), env);
+  if (auto err = self.error(val_pos, val); is_error(err)) {
+    return err;
+  }
+
+  if (val->type() != ObjectType::OBOOL) {
+    return self.derror(val_pos, self.serror("expected a bool type"));
+  }
+
+  bitset->set(i, object::cast<Object, Bool>(std::move(val))->value);
+  return bitset;
+}
+
+auto Eval::assignement_dict(this Eval &self, const std::shared_ptr<Dict> dict,
+                            std::shared_ptr<Expression> index,
+                            std::shared_ptr<Expression> value,
+                            std::shared_ptr<Environment> &env)
+    -> const std::shared_ptr<Object> {
+  auto key_pos = index->position();
+  auto key = self.eval(std::move(index), env);
+  if (auto err = self.error(key_pos, key); is_error(err)) {
+    return err;
+  }
+
+  if (!Dict::hashable(key)) {
+    return self.derror(key_pos,
+                       self.serror("expected an int, string or bool key"));
+  }
+
+  auto val_pos = value->position();
+  auto val = self.eval(std::move(value), env);
+  if (auto err = self.error(val_pos, val); is_error(err)) {
+    return err;
+  }
+
+  dict->set(std::move(key), std::move(val));
+  return dict;
+}
+
+auto Eval::assignement_map(this Eval &self,
+                           const std::shared_ptr<OrderedMap> map,
+                           std::shared_ptr<Expression> index,
+                           std::shared_ptr<Expression> value,
+                           std::shared_ptr<Environment> &env)
+    -> const std::shared_ptr<Object> {
+  auto key_pos = index->position();
+  auto key = self.eval(std::move(index), env);
+  if (auto err = self.error(key_pos, key); is_error(err)) {
+    return err;
+  }
+
+  if (!OrderedMap::orderable(key)) {
+    return self.derror(key_pos,
+                       self.serror("expected an int, float or string key"));
+  }
+
+  if (!map->accepts(key)) {
+    return self.derror(key_pos, self.serror("key type mismatch"));
+  }
+
+  auto val_pos = value->position();
+  auto val = self.eval(std::move(value), env);
+  if (auto err = self.error(val_pos, val); is_error(err)) {
+    return err;
+  }
+
+  if (map->visiting()) {
+    return self.derror(key_pos, self.serror("map changed during visit"));
+  }
+
+  map->set(std::move(key), std::move(val));
+  return map;
+}
+
 auto Eval::assignment(this Eval &self,
                       std::shared_ptr<AssignmentExpression> node,
                       std::shared_ptr<Environment> &env)
@@ -174,12 +309,37 @@ auto Eval::assignment(this Eval &self,
           node->value, env);
 
     case ObjectType::OSTRING: {
-      auto res = self.assignement_string(
-          object::cast<Object, String>(std::move(obj.value())), expr->index,
-          node->value, env);
-      return res;
+      // literals are shared constants, give the variable its own copy
+      auto str = object::cast<Object, String>(std::move(obj.value()));
+      if (str->interned()) {
+        str = str->substr(0, str->size());
+        env->update(ident->value, str);
+      }
+
+      return self.assignement_string(std::move(str), expr->index,
+                                     node->value, env);
     }
 
+    case ObjectType::ODEQUE:
+      return self.assignement_deque(
+          object::cast<Object, Deque>(std::move(obj.value())), expr->index,
+          node->value, env);
+
+    case ObjectType::OBITSET:
+      return self.assignement_bitset(
+          object::cast<Object, Bitset>(std::move(obj.value())), expr->index,
+          node->value, env);
+
+    case ObjectType::ODICT:
+      return self.assignement_dict(
+          object::cast<Object, Dict>(std::move(obj.value())), expr->index,
+          node->value, env);
+
+    case ObjectType::OMAP:
+      return self.assignement_map(
+          object::cast<Object, OrderedMap>(std::move(obj.value())),
+          expr->index, node->value, env);
+
     default:
       return OBJECT_NULL;
     }
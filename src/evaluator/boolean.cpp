@@ -11,14 +11,14 @@ auto Eval::boolean(bool value) -> const std::shared_ptr<Object> {
 }
 
 auto Eval::truthy(const std::shared_ptr<Object> obj) -> bool {
-  if (obj->debug() == OBJECT_NULL->debug())
+  switch (obj->type()) {
+  case ObjectType::ONULL:
     return false;
 
-  if (obj->debug() == OBJECT_TRUE->debug())
-    return true;
-
-  if (obj->debug() == OBJECT_FALSE->debug())
-    return false;
+  case ObjectType::OBOOL:
+    return static_cast<const Bool &>(*obj).value;
 
-  return true;
+  default:
+    return true;
+  }
 }
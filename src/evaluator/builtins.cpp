@@ -1,17 +1,38 @@
+#include <algorithm>
+#include <array>
+#include <charconv>
 #include <cmath>
+#include <compare>
+#include <csv.hpp>
 #include <cstddef>
 #include <cstdint>
 #include <evaluator.hpp>
+#include <expected>
+#include <filesystem>
+#include <format>
+#include <fstream>
 #include <iterator>
+#include <json.hpp>
+#include <kernels.hpp>
 #include <list>
 #include <memory>
 #include <object.hpp>
+#include <optional>
+#include <regex.hpp>
+#include <snapshot.hpp>
+#include <span>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 using namespace object;
 using namespace evaluator;
 
 auto Eval::register_builtin_fn(string name, BuiltinFunction fn) -> void {
   auto res = std::make_shared<Builtin>();
+  res->name = name;
   res->fn = fn;
   this->builinfns[name] = std::move(res);
 }
@@ -27,14 +48,63 @@ auto Eval::builtin_fn_len(this Eval &self,
   case ObjectType::OSTRING: {
     auto arg = object::cast<Object, String>(std::move(args.front()));
     auto res = std::make_shared<Integer>();
-    res->value = arg->value.size();
+    res->value = arg->size();
     return res;
   }
 
   case ObjectType::OARRAY: {
     auto arg = object::cast<Object, Array>(std::move(args.front()));
     auto res = std::make_shared<Integer>();
-    res->value = arg->elements.size();
+    res->value = arg->size();
+    return res;
+  }
+
+  case ObjectType::ODICT: {
+    auto arg = object::cast<Object, Dict>(std::move(args.front()));
+    auto res = std::make_shared<Integer>();
+    res->value = arg->size();
+    return res;
+  }
+
+  case ObjectType::OMAP: {
+    auto arg = object::cast<Object, OrderedMap>(std::move(args.front()));
+    auto res = std::make_shared<Integer>();
+    res->value = arg->size();
+    return res;
+  }
+
+  case ObjectType::OPQUEUE: {
+    auto arg = object::cast<Object, PriorityQueue>(std::move(args.front()));
+    auto res = std::make_shared<Integer>();
+    res->value = arg->size();
+    return res;
+  }
+
+  case ObjectType::ODEQUE: {
+    auto arg = object::cast<Object, Deque>(std::move(args.front()));
+    auto res = std::make_shared<Integer>();
+    res->value = arg->size();
+    return res;
+  }
+
+  case ObjectType::OBITSET: {
+    auto arg = object::cast<Object, Bitset>(std::move(args.front()));
+    auto res = std::make_shared<Integer>();
+    res->value = arg->size();
+    return res;
+  }
+
+  case ObjectType::OMATRIX: {
+    auto arg = object::cast<Object, Matrix>(std::move(args.front()));
+    auto res = std::make_shared<Integer>();
+    res->value = arg->rows();
+    return res;
+  }
+
+  case ObjectType::ORANGE: {
+    auto arg = object::cast<Object, Range>(std::move(args.front()));
+    auto res = std::make_shared<Integer>();
+    res->value = arg->size();
     return res;
   }
 
@@ -68,6 +138,17 @@ auto Eval::builtin_fn_int(this Eval &self,
     return res;
   }
 
+  case ObjectType::OSTRING: {
+    auto str = object::cast<Object, String>(args.front())->view();
+    int64_t value;
+    auto end = str.data() + str.size();
+    auto [ptr, ec] = std::from_chars(str.data(), end, value);
+    if (ec != std::errc() || ptr != end) {
+      return self.serror(std::format("cannot parse \"{}\" as an int", str));
+    }
+    return std::make_shared<Integer>(value);
+  }
+
   default:
     return self.serror("type is not supported");
   }
@@ -91,6 +172,17 @@ auto Eval::builtin_fn_float(this Eval &self,
     return res;
   }
 
+  case ObjectType::OSTRING: {
+    auto str = object::cast<Object, String>(args.front())->view();
+    double value;
+    auto end = str.data() + str.size();
+    auto [ptr, ec] = std::from_chars(str.data(), end, value);
+    if (ec != std::errc() || ptr != end) {
+      return self.serror(std::format("cannot parse \"{}\" as a float", str));
+    }
+    return std::make_shared<Float>(value);
+  }
+
   default:
     return self.serror("type is not supported");
   }
@@ -103,9 +195,7 @@ auto Eval::builtin_fn_type(this Eval &self,
     return self.serror("type() only accepts one argument");
   }
 
-  auto res = std::make_shared<String>();
-  res->value = OBJECT_TYPE_NAME.at(args.front()->type());
-  return res;
+  return std::make_shared<String>(OBJECT_TYPE_NAME.at(args.front()->type()));
 }
 
 auto Eval::builtin_fn_print(this Eval &self,
@@ -160,14 +250,21 @@ auto Eval::builtin_fn_push(this Eval &self,
 
   auto it = args.begin();
   auto arr = std::move(*it);
+  std::advance(it, 1);
+  auto val = std::move(*it);
+
+  if (arr->type() == ObjectType::ODEQUE) {
+    auto res = object::cast<Object, Deque>(arr);
+    res->push_back(std::move(val));
+    return res;
+  }
+
   if (arr->type() != ObjectType::OARRAY) {
-    return self.serror("expected an array type");
+    return self.serror("expected an array or deque type");
   }
 
-  std::advance(it, 1);
-  auto val = std::move(*it);
   auto res = object::cast<Object, Array>(arr);
-  res->elements.push_back(std::move(val));
+  res->push(std::move(val));
   return res;
 }
 
@@ -179,12 +276,85 @@ auto Eval::builtin_fn_pop(this Eval &self,
   }
 
   auto arr = std::move(args.front());
+  if (arr->type() == ObjectType::ODEQUE) {
+    auto res = object::cast<Object, Deque>(arr);
+    if (res->size() == 0) {
+      return self.serror("cannot pop from an empty deque");
+    }
+
+    res->pop_back();
+    return res;
+  }
+
   if (arr->type() != ObjectType::OARRAY) {
-    return self.serror("expected an array type");
+    return self.serror("expected an array or deque type");
   }
 
   auto res = object::cast<Object, Array>(arr);
-  res->elements.pop_back();
+  if (res->size() == 0) {
+    return self.serror("cannot pop from an empty array");
+  }
+
+  res->pop();
+  return res;
+}
+
+auto Eval::builtin_fn_deque(this Eval &self,
+                            const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() > 1) {
+    return self.serror("deque() accepts at most one argument");
+  }
+
+  auto res = std::make_shared<Deque>();
+  if (args.empty()) {
+    return res;
+  }
+
+  if (args.front()->type() != ObjectType::OARRAY) {
+    return self.serror("expected an array type");
+  }
+
+  auto arr = object::cast<Object, Array>(args.front());
+  for (size_t i = 0; i < arr->size(); i++) {
+    res->push_back(arr->at(i));
+  }
+  return res;
+}
+
+auto Eval::builtin_fn_push_front(
+    this Eval &self, const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 2) {
+    return self.serror("push_front() requires 2 arguments");
+  }
+
+  if (args.front()->type() != ObjectType::ODEQUE) {
+    return self.serror("expected a deque type");
+  }
+
+  auto res = object::cast<Object, Deque>(args.front());
+  res->push_front(args.back());
+  return res;
+}
+
+auto Eval::builtin_fn_pop_front(
+    this Eval &self, const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 1) {
+    return self.serror("pop_front() only accepts one argument");
+  }
+
+  if (args.front()->type() != ObjectType::ODEQUE) {
+    return self.serror("expected a deque type");
+  }
+
+  auto res = object::cast<Object, Deque>(args.front());
+  if (res->size() == 0) {
+    return self.serror("cannot pop from an empty deque");
+  }
+
+  res->pop_front();
   return res;
 }
 
@@ -200,11 +370,8 @@ auto Eval::builtin_fn_slice(this Eval &self,
     auto arr_val = object::cast<Object, Array>(arr);
 
     switch (args.size()) {
-    case 1: {
-      auto res = std::make_shared<Array>();
-      res->elements = arr_val->elements;
-      return res;
-    }
+    case 1:
+      return arr_val->slice(0, arr_val->size());
 
     case 3: {
       std::advance(it, 1);
@@ -221,7 +388,7 @@ auto Eval::builtin_fn_slice(this Eval &self,
 
       auto start_val = object::cast<Object, Integer>(std::move(start))->value;
       auto end_val = object::cast<Object, Integer>(std::move(end))->value;
-      auto len_val = arr_val->elements.size();
+      auto len_val = arr_val->size();
 
       if (start_val < 0 || end_val < 0 ||
           static_cast<size_t>(start_val) > len_val ||
@@ -233,13 +400,1758 @@ auto Eval::builtin_fn_slice(this Eval &self,
         return self.serror("start index is greater than end index");
       }
 
-      auto res = std::make_unique<Array>();
-      res->elements.assign(arr_val->elements.begin() + start_val,
-                           arr_val->elements.begin() + end_val);
-      return res;
+      return arr_val->slice(start_val, end_val);
     }
     }
   }
 
   return self.serror("slice() requires either 1 or 3 argument");
 }
+
+auto Eval::builtin_fn_keys(this Eval &self,
+                           const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 1) {
+    return self.serror("keys() only accepts one argument");
+  }
+
+  auto res = std::vector<std::shared_ptr<Object>>();
+  switch (args.front()->type()) {
+  case ObjectType::ODICT: {
+    auto dict = object::cast<Object, Dict>(args.front());
+    res.reserve(dict->size());
+    dict->each([&](const auto &key, const auto &) { res.push_back(key); });
+    break;
+  }
+
+  case ObjectType::OMAP: {
+    auto map = object::cast<Object, OrderedMap>(args.front());
+    res.reserve(map->size());
+    map->each(nullptr, nullptr, [&](const auto &key, const auto &) {
+      res.push_back(key);
+      return true;
+    });
+    break;
+  }
+
+  default:
+    return self.serror("expected a dict or map type");
+  }
+
+  return std::make_shared<Array>(std::move(res));
+}
+
+auto Eval::builtin_fn_has(this Eval &self,
+                          const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 2) {
+    return self.serror("has() requires 2 arguments");
+  }
+
+  switch (args.front()->type()) {
+  case ObjectType::ODICT: {
+    if (!Dict::hashable(args.back())) {
+      return self.serror("expected an int, string or bool key");
+    }
+
+    auto dict = object::cast<Object, Dict>(args.front());
+    return self.boolean(dict->get(args.back()) != nullptr);
+  }
+
+  case ObjectType::OMAP: {
+    if (!OrderedMap::orderable(args.back())) {
+      return self.serror("expected an int, float or string key");
+    }
+
+    auto map = object::cast<Object, OrderedMap>(args.front());
+    return self.boolean(map->accepts(args.back()) &&
+                        map->get(args.back()) != nullptr);
+  }
+
+  default:
+    return self.serror("expected a dict or map type");
+  }
+}
+
+auto Eval::builtin_fn_remove(this Eval &self,
+                             const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 2) {
+    return self.serror("remove() requires 2 arguments");
+  }
+
+  switch (args.front()->type()) {
+  case ObjectType::ODICT: {
+    if (!Dict::hashable(args.back())) {
+      return self.serror("expected an int, string or bool key");
+    }
+
+    auto dict = object::cast<Object, Dict>(args.front());
+    if (!dict->remove(args.back())) {
+      return self.serror("key not found");
+    }
+
+    return dict;
+  }
+
+  case ObjectType::OMAP: {
+    if (!OrderedMap::orderable(args.back())) {
+      return self.serror("expected an int, float or string key");
+    }
+
+    auto map = object::cast<Object, OrderedMap>(args.front());
+    if (map->visiting()) {
+      return self.serror("map changed during visit");
+    }
+
+    if (!map->accepts(args.back()) || !map->remove(args.back())) {
+      return self.serror("key not found");
+    }
+
+    return map;
+  }
+
+  default:
+    return self.serror("expected a dict or map type");
+  }
+}
+
+auto Eval::builtin_fn_omap(this Eval &self,
+                           const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (!args.empty()) {
+    return self.serror("omap() takes no arguments");
+  }
+
+  return std::make_shared<OrderedMap>();
+}
+
+// the map and key a bound builtin works on, or the error to report
+static auto bound_args(const std::list<std::shared_ptr<Object>> &args)
+    -> std::expected<std::shared_ptr<OrderedMap>, string> {
+  if (args.front()->type() != ObjectType::OMAP) {
+    return std::unexpected("expected a map type");
+  }
+
+  if (!OrderedMap::orderable(args.back())) {
+    return std::unexpected("expected an int, float or string key");
+  }
+
+  auto map = object::cast<Object, OrderedMap>(args.front());
+  if (!map->accepts(args.back())) {
+    return std::unexpected("key type mismatch");
+  }
+
+  return map;
+}
+
+auto Eval::builtin_fn_lower_bound(
+    this Eval &self, const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 2) {
+    return self.serror("lower_bound() requires 2 arguments");
+  }
+
+  auto map = bound_args(args);
+  if (!map.has_value()) {
+    return self.serror(map.error());
+  }
+
+  auto res = map.value()->lower_bound(args.back());
+  return res ? res : OBJECT_NULL;
+}
+
+auto Eval::builtin_fn_upper_bound(
+    this Eval &self, const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 2) {
+    return self.serror("upper_bound() requires 2 arguments");
+  }
+
+  auto map = bound_args(args);
+  if (!map.has_value()) {
+    return self.serror(map.error());
+  }
+
+  auto res = map.value()->upper_bound(args.back());
+  return res ? res : OBJECT_NULL;
+}
+
+// calls fn(key, value) in key order for from <= key < to without
+// building an array, a null bound is open and fn returning false stops
+auto Eval::builtin_fn_visit(this Eval &self,
+                            const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 4) {
+    return self.serror("visit() requires 4 arguments");
+  }
+
+  auto it = args.begin();
+  auto map_arg = *it++;
+  auto from = *it++;
+  auto to = *it++;
+  auto fn = *it;
+
+  if (map_arg->type() != ObjectType::OMAP) {
+    return self.serror("expected a map type");
+  }
+
+  auto map = object::cast<Object, OrderedMap>(map_arg);
+  for (auto *bound : {&from, &to}) {
+    if ((*bound)->type() == ObjectType::ONULL) {
+      *bound = nullptr;
+      continue;
+    }
+
+    if (!OrderedMap::orderable(*bound)) {
+      return self.serror("expected an int, float or string key");
+    }
+
+    if (!map->accepts(*bound)) {
+      return self.serror("key type mismatch");
+    }
+  }
+
+  auto caller = self.caller(fn, 2);
+  if (!caller.has_value()) {
+    return self.serror(caller.error());
+  }
+
+  auto res = OBJECT_NULL;
+  map->each(from, to, [&](const auto &key, const auto &value) {
+    caller->args[0] = key;
+    caller->args[1] = value;
+    auto out = self.call(*caller);
+    if (is_error(out)) {
+      res = out;
+      return false;
+    }
+
+    return out->type() != ObjectType::OBOOL ||
+           object::cast<Object, Bool>(out)->value;
+  });
+
+  return res;
+}
+
+// the values of an array of ints or floats as doubles
+static auto row_values(const std::shared_ptr<Object> &obj)
+    -> std::optional<std::vector<double>> {
+  if (obj->type() != ObjectType::OARRAY) {
+    return std::nullopt;
+  }
+
+  auto arr = object::cast<Object, Array>(obj);
+  if (auto floats = arr->floats()) {
+    return std::vector<double>(floats->begin(), floats->end());
+  }
+  if (auto ints = arr->ints()) {
+    return std::vector<double>(ints->begin(), ints->end());
+  }
+  if (arr->size() == 0) {
+    return std::vector<double>();
+  }
+  return std::nullopt;
+}
+
+// why an array of boxed elements cannot be sorted, empty when it can.
+// elements must all be strings, or all ints or floats
+static auto unsortable(const std::shared_ptr<Array> &arr) -> string {
+  auto first = arr->at(0)->type();
+  if (first != ObjectType::OINT && first != ObjectType::OFLOAT &&
+      first != ObjectType::OSTRING) {
+    return std::format("cannot sort an array of {}",
+                       OBJECT_TYPE_NAME.at(first));
+  }
+
+  for (size_t i = 1; i < arr->size(); i++) {
+    if (auto type = arr->at(i)->type(); type != first) {
+      return std::format(
+          "cannot sort an array mixing {} and {}", OBJECT_TYPE_NAME.at(first),
+          OBJECT_TYPE_NAME.contains(type) ? OBJECT_TYPE_NAME.at(type)
+                                          : string("internal value"));
+    }
+  }
+  return "";
+}
+
+// the string arguments of a string builtin, null when one is not
+template <size_t N>
+static auto string_args(const std::list<std::shared_ptr<Object>> &args)
+    -> std::optional<std::array<std::shared_ptr<String>, N>> {
+  std::array<std::shared_ptr<String>, N> res;
+  auto it = args.begin();
+  for (auto &str : res) {
+    if ((*it)->type() != ObjectType::OSTRING) {
+      return std::nullopt;
+    }
+    str = object::cast<Object, String>(*it++);
+  }
+  return res;
+}
+
+auto Eval::builtin_fn_find(this Eval &self,
+                           const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 2 && args.size() != 3) {
+    return self.serror("find() requires either 2 or 3 arguments");
+  }
+
+  auto strs = string_args<2>(args);
+  if (!strs.has_value()) {
+    return self.serror("expected a string type");
+  }
+
+  int64_t from = 0;
+  if (args.size() == 3) {
+    if (args.back()->type() != ObjectType::OINT) {
+      return self.serror("expected an int type");
+    }
+    from = std::max<int64_t>(
+        object::cast<Object, Integer>(args.back())->value, 0);
+  }
+
+  auto [str, sub] = strs.value();
+  auto pos = kernels::Finder(sub->view()).find(str->view(), from);
+  return std::make_shared<Integer>(
+      pos == kernels::Finder::NPOS ? -1 : static_cast<int64_t>(pos));
+}
+
+auto Eval::builtin_fn_contains(this Eval &self,
+                               const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 2) {
+    return self.serror("contains() requires 2 arguments");
+  }
+
+  auto strs = string_args<2>(args);
+  if (!strs.has_value()) {
+    return self.serror("expected a string type");
+  }
+
+  auto [str, sub] = strs.value();
+  return self.boolean(kernels::Finder(sub->view()).find(str->view()) !=
+                      kernels::Finder::NPOS);
+}
+
+// the pieces share the buffer of the split string
+auto Eval::builtin_fn_split(this Eval &self,
+                            const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 2) {
+    return self.serror("split() requires 2 arguments");
+  }
+
+  auto strs = string_args<2>(args);
+  if (!strs.has_value()) {
+    return self.serror("expected a string type");
+  }
+
+  auto [str, sep] = strs.value();
+  if (sep->size() == 0) {
+    return self.serror("expected a non empty separator");
+  }
+
+  auto finder = kernels::Finder(sep->view());
+  auto res = Array::Boxed();
+  size_t start = 0;
+  for (;;) {
+    auto pos = finder.find(str->view(), start);
+    if (pos == kernels::Finder::NPOS) {
+      res.push_back(str->substr(start, str->size() - start));
+      break;
+    }
+    res.push_back(str->substr(start, pos - start));
+    start = pos + sep->size();
+  }
+  return std::make_shared<Array>(std::move(res));
+}
+
+auto Eval::builtin_fn_join(this Eval &self,
+                           const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 2) {
+    return self.serror("join() requires 2 arguments");
+  }
+
+  if (args.front()->type() != ObjectType::OARRAY ||
+      args.back()->type() != ObjectType::OSTRING) {
+    return self.serror("expected an array and a string");
+  }
+
+  auto arr = object::cast<Object, Array>(args.front());
+  auto sep = object::cast<Object, String>(args.back())->view();
+  size_t size = 0;
+  for (size_t i = 0; i < arr->size(); i++) {
+    auto e = arr->at(i);
+    if (e->type() != ObjectType::OSTRING) {
+      return self.serror("expected an array of strings");
+    }
+    size += object::cast<Object, String>(e)->size() + (i ? sep.size() : 0);
+  }
+
+  auto res = string();
+  res.reserve(size);
+  for (size_t i = 0; i < arr->size(); i++) {
+    if (i) {
+      res += sep;
+    }
+    res += object::cast<Object, String>(arr->at(i))->view();
+  }
+  return std::make_shared<String>(std::move(res));
+}
+
+// a string without a match is returned as is
+auto Eval::builtin_fn_replace(this Eval &self,
+                              const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 3) {
+    return self.serror("replace() requires 3 arguments");
+  }
+
+  auto strs = string_args<3>(args);
+  if (!strs.has_value()) {
+    return self.serror("expected a string type");
+  }
+
+  auto [str, from, to] = strs.value();
+  if (from->size() == 0) {
+    return self.serror("expected a non empty pattern");
+  }
+
+  auto finder = kernels::Finder(from->view());
+  auto view = str->view();
+  auto pos = finder.find(view);
+  if (pos == kernels::Finder::NPOS) {
+    return str;
+  }
+
+  auto res = string();
+  res.reserve(view.size());
+  size_t start = 0;
+  for (; pos != kernels::Finder::NPOS; pos = finder.find(view, start)) {
+    res += view.substr(start, pos - start);
+    res += to->view();
+    start = pos + from->size();
+  }
+  res += view.substr(start);
+  return std::make_shared<String>(std::move(res));
+}
+
+auto Eval::builtin_fn_trim(this Eval &self,
+                           const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 1) {
+    return self.serror("trim() only accepts one argument");
+  }
+
+  if (args.front()->type() != ObjectType::OSTRING) {
+    return self.serror("expected a string type");
+  }
+
+  auto str = object::cast<Object, String>(args.front());
+  auto view = str->view();
+  auto first = view.find_first_not_of(" \t\n\r\v\f");
+  if (first == string_view::npos) {
+    return str->substr(0, 0);
+  }
+
+  auto last = view.find_last_not_of(" \t\n\r\v\f");
+  return str->substr(first, last - first + 1);
+}
+
+auto Patterns::get(this Patterns &self, string_view pattern)
+    -> std::expected<std::shared_ptr<Regex>, string> {
+  if (auto it = self.compiled.find(pattern); it != self.compiled.end()) {
+    return it->second;
+  }
+
+  auto compiled = regex::Regex::compile(pattern);
+  if (!compiled.has_value()) {
+    return std::unexpected(compiled.error());
+  }
+
+  if (self.compiled.size() >= LIMIT) {
+    self.compiled.clear();
+  }
+  auto res = std::make_shared<Regex>(
+      string(pattern),
+      std::make_shared<regex::Regex>(std::move(compiled.value())));
+  self.compiled.emplace(string(pattern), res);
+  return res;
+}
+
+// a compiled regex, or a pattern compiled through the cache
+static auto regex_arg(Patterns &patterns, const std::shared_ptr<Object> &arg)
+    -> std::expected<std::shared_ptr<Regex>, string> {
+  if (arg->type() == ObjectType::OREGEX) {
+    return object::cast<Object, Regex>(arg);
+  }
+  if (arg->type() == ObjectType::OSTRING) {
+    return patterns.get(object::cast<Object, String>(arg)->view());
+  }
+  return std::unexpected("expected a regex or a string pattern");
+}
+
+auto Eval::builtin_fn_re_compile(
+    this Eval &self, const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 1) {
+    return self.serror("re_compile() only accepts one argument");
+  }
+
+  if (args.front()->type() != ObjectType::OSTRING) {
+    return self.serror("expected a string type");
+  }
+
+  auto re = regex_arg(*self.patterns, args.front());
+  if (!re.has_value()) {
+    return self.serror(re.error());
+  }
+  return re.value();
+}
+
+// true when the whole string matches
+auto Eval::builtin_fn_re_match(this Eval &self,
+                               const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 2) {
+    return self.serror("re_match() requires 2 arguments");
+  }
+
+  if (args.back()->type() != ObjectType::OSTRING) {
+    return self.serror("expected a string type");
+  }
+
+  auto re = regex_arg(*self.patterns, args.front());
+  if (!re.has_value()) {
+    return self.serror(re.error());
+  }
+
+  auto str = object::cast<Object, String>(args.back());
+  return self.boolean(re.value()->compiled().full(str->view()));
+}
+
+// the leftmost-longest matches, they share the buffer of the string
+auto Eval::builtin_fn_re_find_all(
+    this Eval &self, const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 2) {
+    return self.serror("re_find_all() requires 2 arguments");
+  }
+
+  if (args.back()->type() != ObjectType::OSTRING) {
+    return self.serror("expected a string type");
+  }
+
+  auto re = regex_arg(*self.patterns, args.front());
+  if (!re.has_value()) {
+    return self.serror(re.error());
+  }
+
+  auto str = object::cast<Object, String>(args.back());
+  auto res = Array::Boxed();
+  for (auto [start, end] : re.value()->compiled().find_all(str->view())) {
+    res.push_back(str->substr(start, end - start));
+  }
+  return std::make_shared<Array>(std::move(res));
+}
+
+auto Eval::builtin_fn_json_parse(
+    this Eval &self, const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 1) {
+    return self.serror("json_parse() only accepts one argument");
+  }
+
+  if (args.front()->type() != ObjectType::OSTRING) {
+    return self.serror("expected a string type");
+  }
+
+  auto res = json::parse(object::cast<Object, String>(args.front())->view());
+  if (!res.has_value()) {
+    return self.serror(res.error());
+  }
+  return res.value();
+}
+
+auto Eval::builtin_fn_json_stringify(
+    this Eval &self, const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 1) {
+    return self.serror("json_stringify() only accepts one argument");
+  }
+
+  auto res = json::stringify(args.front());
+  if (!res.has_value()) {
+    return self.serror(res.error());
+  }
+  return std::make_shared<String>(std::move(res.value()));
+}
+
+// calls fn with every top-level value of a json or ndjson file as it
+// is read, returning false from fn stops early
+auto Eval::builtin_fn_json_each(
+    this Eval &self, const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 2) {
+    return self.serror("json_each() requires 2 arguments");
+  }
+
+  if (args.front()->type() != ObjectType::OSTRING) {
+    return self.serror("expected a string type for path");
+  }
+  auto caller = self.caller(args.back(), 1);
+  if (!caller.has_value()) {
+    return self.serror(caller.error());
+  }
+
+  auto path = string(object::cast<Object, String>(args.front())->view());
+  auto stream = json::Stream::open(path);
+  if (!stream.has_value()) {
+    return self.serror(stream.error());
+  }
+
+  for (;;) {
+    auto value = stream->next();
+    if (!value.has_value()) {
+      return self.serror(value.error());
+    }
+    if (!value.value()) {
+      return OBJECT_NULL;
+    }
+
+    caller->args[0] = std::move(value.value());
+    auto out = self.call(*caller);
+    if (is_error(out)) {
+      return out;
+    }
+    if (out->type() == ObjectType::OBOOL &&
+        !object::cast<Object, Bool>(out)->value) {
+      return OBJECT_NULL;
+    }
+  }
+}
+
+struct CsvArgs {
+  string path;
+  std::vector<string> columns;
+  char delimiter = ',';
+};
+
+// a path, then optionally an array of column names (empty for all of
+// them) and a one character delimiter
+static auto csv_args(const std::shared_ptr<Object> &path,
+                     std::list<std::shared_ptr<Object>>::const_iterator it,
+                     std::list<std::shared_ptr<Object>>::const_iterator end)
+    -> std::expected<CsvArgs, string> {
+  if (path->type() != ObjectType::OSTRING) {
+    return std::unexpected("expected a string type for path");
+  }
+  auto res = CsvArgs();
+  res.path = object::cast<Object, String>(path)->view();
+
+  if (it != end) {
+    if ((*it)->type() != ObjectType::OARRAY) {
+      return std::unexpected("expected an array of column names");
+    }
+    auto names = object::cast<Object, Array>(*it++);
+    for (size_t i = 0; i < names->size(); i++) {
+      auto name = names->at(i);
+      if (name->type() != ObjectType::OSTRING) {
+        return std::unexpected("expected an array of column names");
+      }
+      res.columns.emplace_back(object::cast<Object, String>(name)->view());
+    }
+  }
+
+  if (it != end) {
+    auto delimiter = (*it)->type() == ObjectType::OSTRING
+                         ? object::cast<Object, String>(*it)->view()
+                         : string_view();
+    if (delimiter.size() != 1 || delimiter == "\"" || delimiter == "\n" ||
+        delimiter == "\r") {
+      return std::unexpected("expected a one character delimiter");
+    }
+    res.delimiter = delimiter[0];
+  }
+  return res;
+}
+
+auto Eval::builtin_fn_csv_read(this Eval &self,
+                               const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.empty() || args.size() > 3) {
+    return self.serror("csv_read() requires 1 to 3 arguments");
+  }
+
+  auto opts = csv_args(args.front(), std::next(args.begin()), args.end());
+  if (!opts.has_value()) {
+    return self.serror(opts.error());
+  }
+
+  auto res = csv::read(opts->path, opts->columns, opts->delimiter);
+  if (!res.has_value()) {
+    return self.serror(res.error());
+  }
+  return res.value();
+}
+
+// calls fn with the fields of every row after the header as it is
+// read, returning false from fn stops early
+auto Eval::builtin_fn_csv_each(this Eval &self,
+                               const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() < 2 || args.size() > 4) {
+    return self.serror("csv_each() requires 2 to 4 arguments");
+  }
+
+  auto caller = self.caller(*std::next(args.begin()), 1);
+  if (!caller.has_value()) {
+    return self.serror(caller.error());
+  }
+  auto opts = csv_args(args.front(), std::next(args.begin(), 2), args.end());
+  if (!opts.has_value()) {
+    return self.serror(opts.error());
+  }
+
+  auto reader = csv::Reader::open(opts->path, opts->delimiter);
+  if (!reader.has_value()) {
+    return self.serror(reader.error());
+  }
+  auto header = reader->header(opts->columns);
+  if (!header.has_value()) {
+    return self.serror(header.error());
+  }
+
+  auto fields = std::vector<string_view>();
+  for (;;) {
+    auto res = reader->next(fields);
+    if (!res.has_value()) {
+      return self.serror(res.error());
+    }
+    if (!res.value()) {
+      return OBJECT_NULL;
+    }
+
+    auto row = Array::Boxed();
+    row.reserve(fields.size());
+    for (auto field : fields) {
+      row.push_back(csv::field(field));
+    }
+    caller->args[0] = std::make_shared<Array>(std::move(row));
+    auto out = self.call(*caller);
+    if (is_error(out)) {
+      return out;
+    }
+    if (out->type() == ObjectType::OBOOL &&
+        !object::cast<Object, Bool>(out)->value) {
+      return OBJECT_NULL;
+    }
+  }
+}
+
+auto Eval::builtin_fn_serialize(
+    this Eval &self, const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 1) {
+    return self.serror("serialize() only accepts one argument");
+  }
+
+  auto res = snapshot::serialize(args.front());
+  if (!res.has_value()) {
+    return self.serror(res.error());
+  }
+  return std::make_shared<String>(std::move(res.value()));
+}
+
+auto Eval::builtin_fn_deserialize(
+    this Eval &self, const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 1) {
+    return self.serror("deserialize() only accepts one argument");
+  }
+
+  if (args.front()->type() != ObjectType::OSTRING) {
+    return self.serror("expected a string type");
+  }
+
+  auto res =
+      snapshot::deserialize(object::cast<Object, String>(args.front())->view());
+  if (!res.has_value()) {
+    return self.serror(res.error());
+  }
+  return res.value();
+}
+
+auto Eval::builtin_fn_read_file(
+    this Eval &self, const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 1) {
+    return self.serror("read_file() only accepts one argument");
+  }
+
+  if (args.front()->type() != ObjectType::OSTRING) {
+    return self.serror("expected a string type for path");
+  }
+
+  auto path = string(object::cast<Object, String>(args.front())->view());
+  auto file = std::ifstream(path, std::ios::binary | std::ios::ate);
+  if (!file) {
+    return self.serror(std::format("cannot open file: {}", path));
+  }
+
+  // a directory opens fine but has no size
+  auto ec = std::error_code();
+  auto size = file.tellg();
+  if (!std::filesystem::is_regular_file(path, ec) || size < 0) {
+    return self.serror(std::format("cannot read file: {}", path));
+  }
+
+  auto res = string(static_cast<size_t>(size), '\0');
+  file.seekg(0);
+  file.read(res.data(), static_cast<std::streamsize>(res.size()));
+  if (!file) {
+    return self.serror(std::format("cannot read file: {}", path));
+  }
+  return std::make_shared<String>(std::move(res));
+}
+
+auto Eval::builtin_fn_write_file(
+    this Eval &self, const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 2) {
+    return self.serror("write_file() requires 2 arguments");
+  }
+
+  auto strs = string_args<2>(args);
+  if (!strs.has_value()) {
+    return self.serror("expected a string type");
+  }
+
+  auto [path, data] = strs.value();
+  auto file = std::ofstream(string(path->view()),
+                            std::ios::binary | std::ios::trunc);
+  auto view = data->view();
+  file.write(view.data(), static_cast<std::streamsize>(view.size()));
+  if (!file) {
+    return self.serror(std::format("cannot write file: {}", path->view()));
+  }
+  return OBJECT_NULL;
+}
+
+auto Eval::builtin_fn_sort(this Eval &self,
+                           const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 1) {
+    return self.serror("sort() only accepts one argument");
+  }
+
+  if (args.front()->type() != ObjectType::OARRAY) {
+    return self.serror("expected an array type");
+  }
+
+  auto arr = object::cast<Object, Array>(args.front());
+  if (!arr->ints() && !arr->floats() && arr->size() != 0) {
+    // stays boxed after its odd element was overwritten, a fresh copy
+    // of an int-only or float-only array is packed again
+    auto boxed = Array::Boxed();
+    boxed.reserve(arr->size());
+    for (size_t i = 0; i < arr->size(); i++) {
+      boxed.push_back(arr->at(i));
+    }
+    arr = std::make_shared<Array>(std::move(boxed));
+  }
+
+  if (auto ints = arr->ints()) {
+    auto res = Array::Ints(ints->begin(), ints->end());
+    kernels::sort(res);
+    return std::make_shared<Array>(std::move(res));
+  }
+
+  if (auto floats = arr->floats()) {
+    auto res = Array::Floats(floats->begin(), floats->end());
+    kernels::sort(res);
+    return std::make_shared<Array>(std::move(res));
+  }
+
+  if (arr->size() == 0) {
+    return std::make_shared<Array>();
+  }
+
+  if (auto err = unsortable(arr); !err.empty()) {
+    return self.serror(err);
+  }
+
+  // packed arrays took the branches above, what is left are strings
+  auto res = Array::Boxed();
+  res.reserve(arr->size());
+  for (size_t i = 0; i < arr->size(); i++) {
+    res.push_back(arr->at(i));
+  }
+  std::ranges::stable_sort(res, {}, [](const auto &obj) {
+    return static_cast<const String &>(*obj).view();
+  });
+  return std::make_shared<Array>(std::move(res));
+}
+
+// fn is called once per element for its key, the elements are then
+// ordered by key natively and stably without calling back into eta
+auto Eval::builtin_fn_sort_by(this Eval &self,
+                              const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 2) {
+    return self.serror("sort_by() requires 2 arguments");
+  }
+
+  if (args.front()->type() != ObjectType::OARRAY) {
+    return self.serror("expected an array type");
+  }
+
+  auto arr = object::cast<Object, Array>(args.front());
+  auto caller = self.caller(args.back(), 1);
+  if (!caller.has_value()) {
+    return self.serror(caller.error());
+  }
+
+  auto keys = Array::Boxed();
+  keys.reserve(arr->size());
+  for (size_t i = 0; i < arr->size(); i++) {
+    caller->args[0] = arr->at(i);
+    auto key = self.call(*caller);
+    if (is_error(key)) {
+      return key;
+    }
+    keys.push_back(std::move(key));
+  }
+
+  if (keys.empty()) {
+    return std::make_shared<Array>();
+  }
+
+  auto packed = std::make_shared<Array>(keys);
+  if (!packed->ints() && !packed->floats()) {
+    if (auto err = unsortable(packed); !err.empty()) {
+      return self.serror(err);
+    }
+  }
+
+  auto order = std::vector<size_t>(keys.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+
+  if (auto ints = packed->ints()) {
+    std::ranges::stable_sort(order, {}, [&](size_t i) { return (*ints)[i]; });
+  } else if (auto floats = packed->floats()) {
+    std::ranges::stable_sort(order, [&](size_t a, size_t b) {
+      return std::strong_order((*floats)[a], (*floats)[b]) < 0;
+    });
+  } else {
+    std::ranges::stable_sort(order, {}, [&](size_t i) {
+      return static_cast<const String &>(*keys[i]).view();
+    });
+  }
+
+  auto res = Array::Boxed();
+  res.reserve(order.size());
+  for (auto i : order) {
+    res.push_back(arr->at(i));
+  }
+  return std::make_shared<Array>(std::move(res));
+}
+
+// the elements a higher order builtin works on
+static auto each_args(const std::list<std::shared_ptr<Object>> &args)
+    -> std::expected<Iterator, string> {
+  if (!Iterator::iterable(args.front())) {
+    return std::unexpected("expected an array, string or range");
+  }
+
+  return Iterator(args.front());
+}
+
+auto Eval::builtin_fn_map(this Eval &self,
+                          const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 2) {
+    return self.serror("map() requires 2 arguments");
+  }
+
+  auto items = each_args(args);
+  if (!items.has_value()) {
+    return self.serror(items.error());
+  }
+  auto caller = self.caller(args.back(), 1);
+  if (!caller.has_value()) {
+    return self.serror(caller.error());
+  }
+
+  auto res = Array::Boxed(items->size());
+  for (size_t i = 0; items->next(caller->args[0]); i++) {
+    auto out = self.call(*caller);
+    if (is_error(out)) {
+      return out;
+    }
+    res[i] = std::move(out);
+  }
+  return std::make_shared<Array>(std::move(res));
+}
+
+auto Eval::builtin_fn_filter(this Eval &self,
+                             const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 2) {
+    return self.serror("filter() requires 2 arguments");
+  }
+
+  auto items = each_args(args);
+  if (!items.has_value()) {
+    return self.serror(items.error());
+  }
+  auto caller = self.caller(args.back(), 1);
+  if (!caller.has_value()) {
+    return self.serror(caller.error());
+  }
+
+  auto res = Array::Boxed();
+  res.reserve(items->size());
+  while (items->next(caller->args[0])) {
+    auto out = self.call(*caller);
+    if (is_error(out)) {
+      return out;
+    }
+    if (self.truthy(out)) {
+      res.push_back(std::move(caller->args[0]));
+    }
+  }
+  return std::make_shared<Array>(std::move(res));
+}
+
+auto Eval::builtin_fn_reduce(this Eval &self,
+                             const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 3) {
+    return self.serror("reduce() requires 3 arguments");
+  }
+
+  auto items = each_args(args);
+  if (!items.has_value()) {
+    return self.serror(items.error());
+  }
+  auto caller = self.caller(*std::next(args.begin()), 2);
+  if (!caller.has_value()) {
+    return self.serror(caller.error());
+  }
+
+  auto acc = args.back();
+  while (items->next(caller->args[1])) {
+    caller->args[0] = std::move(acc);
+    acc = self.call(*caller);
+    if (is_error(acc)) {
+      return acc;
+    }
+  }
+  return acc;
+}
+
+// fn returning false stops the iteration
+auto Eval::builtin_fn_each(this Eval &self,
+                           const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 2) {
+    return self.serror("each() requires 2 arguments");
+  }
+
+  auto items = each_args(args);
+  if (!items.has_value()) {
+    return self.serror(items.error());
+  }
+  auto caller = self.caller(args.back(), 1);
+  if (!caller.has_value()) {
+    return self.serror(caller.error());
+  }
+
+  while (items->next(caller->args[0])) {
+    auto out = self.call(*caller);
+    if (is_error(out)) {
+      return out;
+    }
+    if (out->type() == ObjectType::OBOOL &&
+        !object::cast<Object, Bool>(out)->value) {
+      break;
+    }
+  }
+  return OBJECT_NULL;
+}
+
+// range(end), range(start, end) or range(start, end, step)
+auto Eval::builtin_fn_range(this Eval &self,
+                            const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.empty() || args.size() > 3) {
+    return self.serror("range() requires 1 to 3 arguments");
+  }
+
+  auto bounds = std::array<int64_t, 3>{0, 0, 1};
+  auto it = args.begin();
+  for (size_t i = args.size() == 1; it != args.end(); i++, it++) {
+    if ((*it)->type() != ObjectType::OINT) {
+      return self.serror("expected an int type");
+    }
+    bounds[i] = object::cast<Object, Integer>(*it)->value;
+  }
+
+  if (bounds[2] == 0) {
+    return self.serror("range step cannot be 0");
+  }
+
+  return std::make_shared<Range>(bounds[0], bounds[1], bounds[2]);
+}
+
+auto Eval::builtin_fn_matrix(this Eval &self,
+                             const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() == 1) {
+    if (args.front()->type() != ObjectType::OARRAY) {
+      return self.serror("expected an array of rows");
+    }
+
+    auto rows = object::cast<Object, Array>(args.front());
+    auto values = std::vector<double>();
+    size_t cols = 0;
+    for (size_t i = 0; i < rows->size(); i++) {
+      auto row = row_values(rows->at(i));
+      if (!row.has_value()) {
+        return self.serror("expected rows of ints or floats");
+      }
+
+      if (i == 0) {
+        cols = row->size();
+        values.reserve(rows->size() * cols);
+      } else if (row->size() != cols) {
+        return self.serror("rows differ in length");
+      }
+      values.insert(values.end(), row->begin(), row->end());
+    }
+
+    return std::make_shared<Matrix>(rows->size(), cols, std::move(values));
+  }
+
+  if (args.size() != 2) {
+    return self.serror("matrix() accepts either 1 or 2 arguments");
+  }
+
+  if (args.front()->type() != ObjectType::OINT ||
+      args.back()->type() != ObjectType::OINT) {
+    return self.serror("expected an int type");
+  }
+
+  auto rows = object::cast<Object, Integer>(args.front())->value;
+  auto cols = object::cast<Object, Integer>(args.back())->value;
+  int64_t size = 0;
+  if (rows < 0 || cols < 0) {
+    return self.serror("invalid matrix shape");
+  }
+
+  if (__builtin_mul_overflow(rows, cols, &size) ||
+      static_cast<uint64_t>(size) > Matrix::LIMIT) {
+    return self.serror(std::format(
+        "matrix size exceeds the limit of {} cells", Matrix::LIMIT));
+  }
+
+  return std::make_shared<Matrix>(rows, cols);
+}
+
+// the matrix and cell named by the first three arguments of mat_get
+// or mat_set, or the error to report
+static auto cell(const std::list<std::shared_ptr<Object>> &args)
+    -> std::expected<std::tuple<std::shared_ptr<Matrix>, size_t, size_t>,
+                     string> {
+  auto it = args.begin();
+  auto mat = *it++;
+  auto i = *it++;
+  auto j = *it;
+  if (mat->type() != ObjectType::OMATRIX) {
+    return std::unexpected("expected a matrix type");
+  }
+
+  if (i->type() != ObjectType::OINT || j->type() != ObjectType::OINT) {
+    return std::unexpected("expected an int type for index");
+  }
+
+  auto m = object::cast<Object, Matrix>(mat);
+  auto row = object::cast<Object, Integer>(i)->value;
+  auto col = object::cast<Object, Integer>(j)->value;
+  if (row < 0 || (size_t)row >= m->rows() || col < 0 ||
+      (size_t)col >= m->cols()) {
+    return std::unexpected("index out of range");
+  }
+
+  return std::tuple(std::move(m), row, col);
+}
+
+auto Eval::builtin_fn_mat_get(this Eval &self,
+                              const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 3) {
+    return self.serror("mat_get() requires 3 arguments");
+  }
+
+  auto res = cell(args);
+  if (!res.has_value()) {
+    return self.serror(res.error());
+  }
+
+  auto [mat, i, j] = res.value();
+  return std::make_shared<Float>(mat->at(i, j));
+}
+
+auto Eval::builtin_fn_mat_set(this Eval &self,
+                              const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 4) {
+    return self.serror("mat_set() requires 4 arguments");
+  }
+
+  auto res = cell(args);
+  if (!res.has_value()) {
+    return self.serror(res.error());
+  }
+
+  auto value = args.back();
+  auto [mat, i, j] = res.value();
+  switch (value->type()) {
+  case ObjectType::OINT:
+    mat->set(i, j, object::cast<Object, Integer>(value)->value);
+    return mat;
+
+  case ObjectType::OFLOAT:
+    mat->set(i, j, object::cast<Object, Float>(value)->value);
+    return mat;
+
+  default:
+    return self.serror("expected an int or float type");
+  }
+}
+
+auto Eval::builtin_fn_matmul(this Eval &self,
+                             const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 2) {
+    return self.serror("matmul() requires 2 arguments");
+  }
+
+  if (args.front()->type() != ObjectType::OMATRIX ||
+      args.back()->type() != ObjectType::OMATRIX) {
+    return self.serror("expected a matrix type");
+  }
+
+  auto lhs = object::cast<Object, Matrix>(args.front());
+  auto rhs = object::cast<Object, Matrix>(args.back());
+  if (lhs->cols() != rhs->rows()) {
+    return self.serror("matrix shape mismatch");
+  }
+
+  // an n x 1 by 1 x n product holds n * n cells
+  size_t size = 0;
+  if (__builtin_mul_overflow(lhs->rows(), rhs->cols(), &size) ||
+      size > Matrix::LIMIT) {
+    return self.serror(std::format(
+        "matrix size exceeds the limit of {} cells", Matrix::LIMIT));
+  }
+
+  auto res = std::vector<double>(size);
+  kernels::matmul(lhs->values(), rhs->values(), res, lhs->rows(), lhs->cols(),
+                  rhs->cols());
+  return std::make_shared<Matrix>(lhs->rows(), rhs->cols(), std::move(res));
+}
+
+auto Eval::builtin_fn_transpose(
+    this Eval &self, const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 1) {
+    return self.serror("transpose() only accepts one argument");
+  }
+
+  if (args.front()->type() != ObjectType::OMATRIX) {
+    return self.serror("expected a matrix type");
+  }
+
+  auto mat = object::cast<Object, Matrix>(args.front());
+  auto res = std::vector<double>(mat->values().size());
+  kernels::transpose(mat->values(), res, mat->rows(), mat->cols());
+  return std::make_shared<Matrix>(mat->cols(), mat->rows(), std::move(res));
+}
+
+auto Eval::builtin_fn_shape(this Eval &self,
+                            const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 1) {
+    return self.serror("shape() only accepts one argument");
+  }
+
+  if (args.front()->type() != ObjectType::OMATRIX) {
+    return self.serror("expected a matrix type");
+  }
+
+  auto mat = object::cast<Object, Matrix>(args.front());
+  return std::make_shared<Array>(
+      Array::Ints{static_cast<int64_t>(mat->rows()),
+                  static_cast<int64_t>(mat->cols())});
+}
+
+auto Eval::builtin_fn_bitset(this Eval &self,
+                             const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 1) {
+    return self.serror("bitset() only accepts one argument");
+  }
+
+  if (args.front()->type() != ObjectType::OINT) {
+    return self.serror("expected an int type");
+  }
+
+  auto bits = object::cast<Object, Integer>(args.front())->value;
+  if (bits < 0) {
+    return self.serror("expected a non negative size");
+  }
+
+  if (static_cast<uint64_t>(bits) > Bitset::LIMIT) {
+    return self.serror(
+        std::format("bitset size exceeds the limit of {} bits", Bitset::LIMIT));
+  }
+
+  return std::make_shared<Bitset>(bits);
+}
+
+auto Eval::builtin_fn_popcount(this Eval &self,
+                               const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 1) {
+    return self.serror("popcount() only accepts one argument");
+  }
+
+  if (args.front()->type() != ObjectType::OBITSET) {
+    return self.serror("expected a bitset type");
+  }
+
+  auto bitset = object::cast<Object, Bitset>(args.front());
+  auto res = std::make_shared<Integer>();
+  res->value = static_cast<int64_t>(kernels::popcount(bitset->words()));
+  return res;
+}
+
+// a new bitset holding lhs op rhs, both of the same size
+static auto bit_op(const string &name,
+                   const std::list<std::shared_ptr<Object>> &args,
+                   kernels::BitOp op)
+    -> std::expected<std::shared_ptr<Object>, string> {
+  if (args.size() != 2) {
+    return std::unexpected(name + "() requires 2 arguments");
+  }
+
+  if (args.front()->type() != ObjectType::OBITSET ||
+      args.back()->type() != ObjectType::OBITSET) {
+    return std::unexpected("expected a bitset type");
+  }
+
+  auto lhs = object::cast<Object, Bitset>(args.front());
+  auto rhs = object::cast<Object, Bitset>(args.back());
+  if (lhs->size() != rhs->size()) {
+    return std::unexpected("bitset size mismatch");
+  }
+
+  auto words = std::vector<uint64_t>(lhs->words().size());
+  kernels::bits(op, lhs->words(), rhs->words(), words);
+  return std::make_shared<Bitset>(lhs->size(), std::move(words));
+}
+
+auto Eval::builtin_fn_bit_and(this Eval &self,
+                              const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  auto res = bit_op("bit_and", args, kernels::BitOp::AND);
+  if (!res.has_value()) {
+    return self.serror(res.error());
+  }
+
+  return res.value();
+}
+
+auto Eval::builtin_fn_bit_or(this Eval &self,
+                             const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  auto res = bit_op("bit_or", args, kernels::BitOp::OR);
+  if (!res.has_value()) {
+    return self.serror(res.error());
+  }
+
+  return res.value();
+}
+
+auto Eval::builtin_fn_bit_xor(this Eval &self,
+                              const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  auto res = bit_op("bit_xor", args, kernels::BitOp::XOR);
+  if (!res.has_value()) {
+    return self.serror(res.error());
+  }
+
+  return res.value();
+}
+
+auto Eval::builtin_fn_bit_andnot(
+    this Eval &self, const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  auto res = bit_op("bit_andnot", args, kernels::BitOp::ANDNOT);
+  if (!res.has_value()) {
+    return self.serror(res.error());
+  }
+
+  return res.value();
+}
+
+auto Eval::builtin_fn_next_set(this Eval &self,
+                               const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 2) {
+    return self.serror("next_set() requires 2 arguments");
+  }
+
+  if (args.front()->type() != ObjectType::OBITSET) {
+    return self.serror("expected a bitset type");
+  }
+
+  if (args.back()->type() != ObjectType::OINT) {
+    return self.serror("expected an int type");
+  }
+
+  auto bitset = object::cast<Object, Bitset>(args.front());
+  auto from = std::max<int64_t>(
+      object::cast<Object, Integer>(args.back())->value, 0);
+  auto res = bitset->next(from);
+  return std::make_shared<Integer>(
+      res == bitset->size() ? -1 : static_cast<int64_t>(res));
+}
+
+auto Eval::builtin_fn_pq(this Eval &self,
+                         const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.empty()) {
+    return std::make_shared<PriorityQueue>();
+  }
+
+  if (args.size() != 1) {
+    return self.serror("pq() accepts at most one argument");
+  }
+
+  auto type = args.front()->type();
+  if (type != ObjectType::OFUNCTION && type != ObjectType::OBUILTINFUNCTION) {
+    return self.serror("expected a function type");
+  }
+
+  return std::make_shared<PriorityQueue>(args.front());
+}
+
+// the queue a pq builtin works on, or the error to report
+static auto queue_arg(const std::shared_ptr<Object> &arg)
+    -> std::expected<std::shared_ptr<PriorityQueue>, string> {
+  if (arg->type() != ObjectType::OPQUEUE) {
+    return std::unexpected("expected a pq type");
+  }
+
+  auto queue = object::cast<Object, PriorityQueue>(arg);
+  if (queue->ordering()) {
+    return std::unexpected("pq used inside its own comparator");
+  }
+
+  return queue;
+}
+
+// calls the comparator of a queue, the first error or non bool result
+// is kept in err and every later comparison is skipped
+auto Eval::before(this Eval &self, Caller &cmp,
+                  const std::shared_ptr<Object> &lhs,
+                  const std::shared_ptr<Object> &rhs,
+                  std::shared_ptr<Object> &err) -> bool {
+  if (err) {
+    return false;
+  }
+
+  cmp.args[0] = lhs;
+  cmp.args[1] = rhs;
+  auto res = self.call(cmp);
+  if (is_error(res)) {
+    err = res;
+    return false;
+  }
+
+  if (res->type() != ObjectType::OBOOL) {
+    err = self.serror("comparator must return a bool");
+    return false;
+  }
+
+  return object::cast<Object, Bool>(res)->value;
+}
+
+auto Eval::builtin_fn_pq_push(this Eval &self,
+                              const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 2) {
+    return self.serror("pq_push() requires 2 arguments");
+  }
+
+  auto queue = queue_arg(args.front());
+  if (!queue.has_value()) {
+    return self.serror(queue.error());
+  }
+
+  auto q = queue.value();
+  auto value = args.back();
+  if (!q->comparator()) {
+    if (!PriorityQueue::orderable(value)) {
+      return self.serror("expected an int, float or string");
+    }
+
+    if (!q->accepts(value)) {
+      return self.serror("type mismatch");
+    }
+
+    q->push(std::move(value));
+    return q;
+  }
+
+  auto cmp = self.caller(q->comparator(), 2);
+  if (!cmp.has_value()) {
+    return self.serror(cmp.error());
+  }
+
+  std::shared_ptr<Object> err;
+  q->push(std::move(value), [&](const auto &lhs, const auto &rhs) {
+    return self.before(*cmp, lhs, rhs, err);
+  });
+  return err ? err : q;
+}
+
+auto Eval::builtin_fn_pq_pop(this Eval &self,
+                             const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 1) {
+    return self.serror("pq_pop() only accepts one argument");
+  }
+
+  auto queue = queue_arg(args.front());
+  if (!queue.has_value()) {
+    return self.serror(queue.error());
+  }
+
+  auto q = queue.value();
+  if (q->size() == 0) {
+    return self.serror("pq is empty");
+  }
+
+  if (!q->comparator()) {
+    return q->pop();
+  }
+
+  auto cmp = self.caller(q->comparator(), 2);
+  if (!cmp.has_value()) {
+    return self.serror(cmp.error());
+  }
+
+  std::shared_ptr<Object> err;
+  auto res = q->pop([&](const auto &lhs, const auto &rhs) {
+    return self.before(*cmp, lhs, rhs, err);
+  });
+  return err ? err : res;
+}
+
+auto Eval::builtin_fn_pq_peek(this Eval &self,
+                              const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 1) {
+    return self.serror("pq_peek() only accepts one argument");
+  }
+
+  auto queue = queue_arg(args.front());
+  if (!queue.has_value()) {
+    return self.serror(queue.error());
+  }
+
+  if (queue.value()->size() == 0) {
+    return self.serror("pq is empty");
+  }
+
+  return queue.value()->at(0);
+}
+
+// the packed array a numeric builtin works on, null when the argument
+// is not an array of only ints or only floats
+static auto numeric(const std::shared_ptr<Object> &arg)
+    -> std::shared_ptr<Array> {
+  if (arg->type() != ObjectType::OARRAY) {
+    return nullptr;
+  }
+
+  auto arr = object::cast<Object, Array>(arg);
+  if (arr->size() > 0 && !arr->ints() && !arr->floats()) {
+    return nullptr;
+  }
+  return arr;
+}
+
+auto Eval::builtin_fn_sum(this Eval &self,
+                          const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 1) {
+    return self.serror("sum() only accepts one argument");
+  }
+
+  auto arr = numeric(args.front());
+  if (!arr) {
+    return self.serror("expected a numeric array");
+  }
+
+  if (auto floats = arr->floats()) {
+    return std::make_shared<Float>(kernels::sum(*floats));
+  }
+  return std::make_shared<Integer>(
+      kernels::sum(arr->ints().value_or(std::span<const int64_t>())));
+}
+
+auto Eval::builtin_fn_min(this Eval &self,
+                          const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 1) {
+    return self.serror("min() only accepts one argument");
+  }
+
+  auto arr = numeric(args.front());
+  if (!arr) {
+    return self.serror("expected a numeric array");
+  }
+
+  if (arr->size() == 0) {
+    return self.serror("expected a non empty array");
+  }
+
+  if (auto floats = arr->floats()) {
+    return std::make_shared<Float>(kernels::min(*floats));
+  }
+  return std::make_shared<Integer>(kernels::min(*arr->ints()));
+}
+
+auto Eval::builtin_fn_max(this Eval &self,
+                          const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 1) {
+    return self.serror("max() only accepts one argument");
+  }
+
+  auto arr = numeric(args.front());
+  if (!arr) {
+    return self.serror("expected a numeric array");
+  }
+
+  if (arr->size() == 0) {
+    return self.serror("expected a non empty array");
+  }
+
+  if (auto floats = arr->floats()) {
+    return std::make_shared<Float>(kernels::max(*floats));
+  }
+  return std::make_shared<Integer>(kernels::max(*arr->ints()));
+}
+
+auto Eval::builtin_fn_mean(this Eval &self,
+                           const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 1) {
+    return self.serror("mean() only accepts one argument");
+  }
+
+  auto arr = numeric(args.front());
+  if (!arr) {
+    return self.serror("expected a numeric array");
+  }
+
+  if (arr->size() == 0) {
+    return self.serror("expected a non empty array");
+  }
+
+  auto count = static_cast<double>(arr->size());
+  if (auto floats = arr->floats()) {
+    return std::make_shared<Float>(kernels::sum(*floats) / count);
+  }
+  return std::make_shared<Float>(
+      static_cast<double>(kernels::sum(*arr->ints())) / count);
+}
+
+auto Eval::builtin_fn_dot(this Eval &self,
+                          const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 2) {
+    return self.serror("dot() requires 2 arguments");
+  }
+
+  auto lhs = numeric(args.front());
+  auto rhs = numeric(args.back());
+  if (!lhs || !rhs) {
+    return self.serror("expected a numeric array");
+  }
+
+  if (lhs->size() != rhs->size()) {
+    return self.serror("array length mismatch");
+  }
+
+  if (lhs->size() == 0) {
+    return std::make_shared<Integer>(0);
+  }
+
+  if (auto l = lhs->ints(), r = rhs->ints(); l && r) {
+    return std::make_shared<Integer>(kernels::dot(*l, *r));
+  }
+
+  if (auto l = lhs->floats(), r = rhs->floats(); l && r) {
+    return std::make_shared<Float>(kernels::dot(*l, *r));
+  }
+
+  return self.serror("type mismatch");
+}
+
+// an int or float array reading a file of raw 8 byte values in place,
+// with cow set writes go to private copies of the touched pages
+auto Eval::builtin_fn_mmap_array(
+    this Eval &self, const std::list<std::shared_ptr<Object>> &args)
+    -> const std::shared_ptr<Object> {
+  if (args.size() != 2 && args.size() != 3) {
+    return self.serror("mmap_array() requires either 2 or 3 arguments");
+  }
+
+  auto strs = string_args<2>(args);
+  if (!strs.has_value()) {
+    return self.serror("expected a string type");
+  }
+  auto [path, name] = strs.value();
+
+  auto kind = Mapping::Kind::INTS;
+  if (name->view() == "f64") {
+    kind = Mapping::Kind::FLOATS;
+  } else if (name->view() != "i64") {
+    return self.serror("expected \"i64\" or \"f64\" as the element type");
+  }
+
+  auto cow = false;
+  if (args.size() == 3) {
+    if (args.back()->type() != ObjectType::OBOOL) {
+      return self.serror("expected a bool type");
+    }
+    cow = object::cast<Object, Bool>(args.back())->value;
+  }
+
+  auto mapping = Mapping::open(string(path->view()), kind, cow);
+  if (!mapping.has_value()) {
+    return self.serror(mapping.error());
+  }
+  return std::make_shared<Array>(std::move(mapping.value()));
+}
@@ -1,4 +1,6 @@
 #include "ast.hpp"
+#include <algorithm>
+#include <analysis.hpp>
 #include <evaluator.hpp>
 #include <memory>
 #include <print>
@@ -67,3 +69,66 @@ auto Eval::loop(this Eval &self, std::shared_ptr<ForExpression> node,
     }
   }
 }
+
+// the loop variable has one slot for the whole loop, next() writes each
+// element straight into it
+auto Eval::iterate(this Eval &self, std::shared_ptr<ForInExpression> node,
+                   std::shared_ptr<Environment> &env)
+    -> const std::shared_ptr<Object> {
+  auto iter_pos = node->iterable->position();
+  auto iterable = self.eval(node->iterable, env);
+  if (auto err = self.error(iter_pos, iterable); is_error(err)) {
+    return err;
+  }
+
+  if (!Iterator::iterable(iterable)) {
+    return self.derror(iter_pos,
+                       self.serror("expected an array, string or range"));
+  }
+
+  if (self.builinfns.contains(node->name->value)) {
+    return self.derror(node->name->position(),
+                       self.serror("a function with same name already exists"));
+  }
+
+  // a body declaring variables gets a scope per iteration so that it
+  // can declare them again
+  auto declares = std::ranges::any_of(
+      node->body->statements,
+      [](const auto &stmt) { return stmt->type() == ASTType::LET; });
+
+  // a closure made in the body holds on to the slot of the loop
+  // variable, it gets a new one per iteration to keep that iteration's
+  // value
+  auto closes = analysis::closes(node->body);
+
+  auto items = Iterator(iterable);
+  env->set(node->name->value, OBJECT_NULL);
+  auto slot = env->slot(node->name->value);
+
+  auto res = OBJECT_NULL;
+  auto body_pos = node->body->position();
+  for (;;) {
+    if (closes) {
+      slot = std::make_shared<Slot>();
+      slot->bound = true;
+      env->bind(node->name->value, slot);
+    }
+
+    if (!items.next(slot->value)) {
+      break;
+    }
+
+    auto scope = declares ? std::make_shared<Environment>(env) : env;
+    res = self.eval(node->body, scope);
+    if (auto err = self.error(body_pos, res); is_error(err)) {
+      return err;
+    }
+
+    if (res && res->type() == ObjectType::ORETURNVAL) {
+      return res;
+    }
+  }
+
+  return res;
+}
@@ -14,17 +14,38 @@ auto Eval::serror(string msg) -> const std::shared_ptr<SimpleError> {
 auto Eval::derror(this Eval &self, const types::Position &node_pos,
                   const std::shared_ptr<SimpleError> err)
     -> const std::shared_ptr<DetailedError> {
-  self.lexer.set_position(node_pos);
-  self.lexer.get_token();
+  // a function from a module runs here but its positions point into the
+  // module's source
+  auto lexer = &self.lexer;
+  if (node_pos.source != types::Position::RUNNING &&
+      node_pos.source != self.lexer.get_source()) {
+    lexer = self.modules->lexer(node_pos.source);
+  }
+
+  // without the source text only the message can be shown
+  if (!lexer) {
+    auto origin = node_pos.source == types::Position::SNAPSHOT
+                      ? "code restored from a snapshot"
+                  : node_pos.source == types::Position::SERIALIZED
+                      ? "deserialized code"
+                      : "code from an earlier input";
+    auto res = std::make_shared<DetailedError>();
+    res->value = std::format("eta: \u001b[31merror in {}\033[0m\n"
+                             "   \u001b[31m{}\033[0m\n",
+                             origin, err->value);
+    return res;
+  }
+
+  lexer->set_position(node_pos);
+  lexer->get_token();
 
-  auto pos = self.lexer.get_position();
-  auto last_pos = self.lexer.get_last_position();
+  auto pos = lexer->get_position();
+  auto last_pos = lexer->get_last_position();
   auto error_msg =
       std::format("eta: \u001b[31merror in file: {}:{}:{}\033[0m\n",
-                  self.lexer.get_filename(), last_pos.row + 1,
+                  lexer->get_filename(), last_pos.row + 1,
                   last_pos.cursor - last_pos.linebeg + 1);
-  error_msg +=
-      std::format("{} | {}\n", last_pos.row + 1, self.lexer.get_line());
+  error_msg += std::format("{} | {}\n", last_pos.row + 1, lexer->get_line());
   error_msg += std::format("{}{}   \u001b[31m{}\033[0m\n",
                            std::string(floor(log10(last_pos.row + 1) + 1), ' '),
                            std::string(last_pos.cursor - last_pos.linebeg, ' '),
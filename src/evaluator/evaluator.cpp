@@ -15,7 +15,14 @@ using namespace object;
 using namespace evaluator;
 using namespace ast;
 
-Eval::Eval(lexer::Lexer &l) : lexer(l) {
+Eval::Eval(lexer::Lexer &l)
+    : Eval(l, std::make_shared<Modules>(), std::make_shared<Strings>(),
+           std::make_shared<Patterns>()) {}
+
+Eval::Eval(lexer::Lexer &l, std::shared_ptr<Modules> modules,
+           std::shared_ptr<Strings> strings, std::shared_ptr<Patterns> patterns)
+    : lexer(l), modules(std::move(modules)), strings(std::move(strings)),
+      patterns(std::move(patterns)) {
   register_builtin_fn("len", LAMBDA_BUILTIN_FN(this->builtin_fn_len));
   register_builtin_fn("int", LAMBDA_BUILTIN_FN(this->builtin_fn_int));
   register_builtin_fn("float", LAMBDA_BUILTIN_FN(this->builtin_fn_float));
@@ -26,6 +33,82 @@ Eval::Eval(lexer::Lexer &l) : lexer(l) {
   register_builtin_fn("push", LAMBDA_BUILTIN_FN(this->builtin_fn_push));
   register_builtin_fn("pop", LAMBDA_BUILTIN_FN(this->builtin_fn_pop));
   register_builtin_fn("slice", LAMBDA_BUILTIN_FN(this->builtin_fn_slice));
+  register_builtin_fn("deque", LAMBDA_BUILTIN_FN(this->builtin_fn_deque));
+  register_builtin_fn("push_front",
+                      LAMBDA_BUILTIN_FN(this->builtin_fn_push_front));
+  register_builtin_fn("pop_front",
+                      LAMBDA_BUILTIN_FN(this->builtin_fn_pop_front));
+  register_builtin_fn("keys", LAMBDA_BUILTIN_FN(this->builtin_fn_keys));
+  register_builtin_fn("has", LAMBDA_BUILTIN_FN(this->builtin_fn_has));
+  register_builtin_fn("remove", LAMBDA_BUILTIN_FN(this->builtin_fn_remove));
+  register_builtin_fn("sum", LAMBDA_BUILTIN_FN(this->builtin_fn_sum));
+  register_builtin_fn("min", LAMBDA_BUILTIN_FN(this->builtin_fn_min));
+  register_builtin_fn("max", LAMBDA_BUILTIN_FN(this->builtin_fn_max));
+  register_builtin_fn("mean", LAMBDA_BUILTIN_FN(this->builtin_fn_mean));
+  register_builtin_fn("dot", LAMBDA_BUILTIN_FN(this->builtin_fn_dot));
+  register_builtin_fn("mmap_array",
+                      LAMBDA_BUILTIN_FN(this->builtin_fn_mmap_array));
+  register_builtin_fn("omap", LAMBDA_BUILTIN_FN(this->builtin_fn_omap));
+  register_builtin_fn("lower_bound",
+                      LAMBDA_BUILTIN_FN(this->builtin_fn_lower_bound));
+  register_builtin_fn("upper_bound",
+                      LAMBDA_BUILTIN_FN(this->builtin_fn_upper_bound));
+  register_builtin_fn("visit", LAMBDA_BUILTIN_FN(this->builtin_fn_visit));
+  register_builtin_fn("find", LAMBDA_BUILTIN_FN(this->builtin_fn_find));
+  register_builtin_fn("contains", LAMBDA_BUILTIN_FN(this->builtin_fn_contains));
+  register_builtin_fn("split", LAMBDA_BUILTIN_FN(this->builtin_fn_split));
+  register_builtin_fn("join", LAMBDA_BUILTIN_FN(this->builtin_fn_join));
+  register_builtin_fn("replace", LAMBDA_BUILTIN_FN(this->builtin_fn_replace));
+  register_builtin_fn("trim", LAMBDA_BUILTIN_FN(this->builtin_fn_trim));
+  register_builtin_fn("re_compile",
+                      LAMBDA_BUILTIN_FN(this->builtin_fn_re_compile));
+  register_builtin_fn("re_match", LAMBDA_BUILTIN_FN(this->builtin_fn_re_match));
+  register_builtin_fn("re_find_all",
+                      LAMBDA_BUILTIN_FN(this->builtin_fn_re_find_all));
+  register_builtin_fn("json_parse",
+                      LAMBDA_BUILTIN_FN(this->builtin_fn_json_parse));
+  register_builtin_fn("json_stringify",
+                      LAMBDA_BUILTIN_FN(this->builtin_fn_json_stringify));
+  register_builtin_fn("json_each",
+                      LAMBDA_BUILTIN_FN(this->builtin_fn_json_each));
+  register_builtin_fn("csv_read", LAMBDA_BUILTIN_FN(this->builtin_fn_csv_read));
+  register_builtin_fn("csv_each", LAMBDA_BUILTIN_FN(this->builtin_fn_csv_each));
+  register_builtin_fn("serialize",
+                      LAMBDA_BUILTIN_FN(this->builtin_fn_serialize));
+  register_builtin_fn("deserialize",
+                      LAMBDA_BUILTIN_FN(this->builtin_fn_deserialize));
+  register_builtin_fn("read_file",
+                      LAMBDA_BUILTIN_FN(this->builtin_fn_read_file));
+  register_builtin_fn("write_file",
+                      LAMBDA_BUILTIN_FN(this->builtin_fn_write_file));
+  register_builtin_fn("sort", LAMBDA_BUILTIN_FN(this->builtin_fn_sort));
+  register_builtin_fn("sort_by", LAMBDA_BUILTIN_FN(this->builtin_fn_sort_by));
+  register_builtin_fn("map", LAMBDA_BUILTIN_FN(this->builtin_fn_map));
+  register_builtin_fn("filter", LAMBDA_BUILTIN_FN(this->builtin_fn_filter));
+  register_builtin_fn("reduce", LAMBDA_BUILTIN_FN(this->builtin_fn_reduce));
+  register_builtin_fn("each", LAMBDA_BUILTIN_FN(this->builtin_fn_each));
+  register_builtin_fn("range", LAMBDA_BUILTIN_FN(this->builtin_fn_range));
+  register_builtin_fn("matrix", LAMBDA_BUILTIN_FN(this->builtin_fn_matrix));
+  register_builtin_fn("mat_get", LAMBDA_BUILTIN_FN(this->builtin_fn_mat_get));
+  register_builtin_fn("mat_set", LAMBDA_BUILTIN_FN(this->builtin_fn_mat_set));
+  register_builtin_fn("matmul", LAMBDA_BUILTIN_FN(this->builtin_fn_matmul));
+  register_builtin_fn("transpose",
+                      LAMBDA_BUILTIN_FN(this->builtin_fn_transpose));
+  register_builtin_fn("shape", LAMBDA_BUILTIN_FN(this->builtin_fn_shape));
+  register_builtin_fn("bitset", LAMBDA_BUILTIN_FN(this->builtin_fn_bitset));
+  register_builtin_fn("popcount",
+                      LAMBDA_BUILTIN_FN(this->builtin_fn_popcount));
+  register_builtin_fn("bit_and", LAMBDA_BUILTIN_FN(this->builtin_fn_bit_and));
+  register_builtin_fn("bit_or", LAMBDA_BUILTIN_FN(this->builtin_fn_bit_or));
+  register_builtin_fn("bit_xor", LAMBDA_BUILTIN_FN(this->builtin_fn_bit_xor));
+  register_builtin_fn("bit_andnot",
+                      LAMBDA_BUILTIN_FN(this->builtin_fn_bit_andnot));
+  register_builtin_fn("next_set",
+                      LAMBDA_BUILTIN_FN(this->builtin_fn_next_set));
+  register_builtin_fn("pq", LAMBDA_BUILTIN_FN(this->builtin_fn_pq));
+  register_builtin_fn("pq_push", LAMBDA_BUILTIN_FN(this->builtin_fn_pq_push));
+  register_builtin_fn("pq_pop", LAMBDA_BUILTIN_FN(this->builtin_fn_pq_pop));
+  register_builtin_fn("pq_peek", LAMBDA_BUILTIN_FN(this->builtin_fn_pq_peek));
 }
 
 auto Eval::eval(std::shared_ptr<Node> node, std::shared_ptr<Environment> &env)
@@ -60,7 +143,10 @@ auto Eval::eval(std::shared_ptr<Node> node, std::shared_ptr<Environment> &env)
       return err;
     }
 
-    auto res = infix(expr->op, std::move(left), std::move(right));
+    // a left operand that cannot escape and is referenced from
+    // nowhere else is a dead temporary, its storage holds the result
+    auto reuse = !expr->left->escapes && left.use_count() == 1;
+    auto res = infix(expr->op, std::move(left), std::move(right), reuse);
     if (auto err = error(expr->position(), res); is_error(err)) {
       return err;
     }
@@ -85,6 +171,11 @@ auto Eval::eval(std::shared_ptr<Node> node, std::shared_ptr<Environment> &env)
     return res;
   }
 
+  case ASTType::IMPORT: {
+    auto stmt = ast::cast<Node, ImportStatement>(std::move(node));
+    return import_module(std::move(stmt), env);
+  }
+
   case ASTType::LET: {
     auto stmt = ast::cast<Node, LetStatement>(std::move(node));
     return declare(std::move(stmt), env);
@@ -115,7 +206,7 @@ auto Eval::eval(std::shared_ptr<Node> node, std::shared_ptr<Environment> &env)
       return err;
     }
 
-    auto res = index(std::move(left), std::move(idx));
+    auto res = index(std::move(left), std::move(idx), expr->escapes);
     if (auto err = error(expr->position(), res); is_error(err)) {
       return err;
     }
@@ -143,7 +234,7 @@ auto Eval::eval(std::shared_ptr<Node> node, std::shared_ptr<Environment> &env)
 
     auto res = std::make_shared<Function>();
     res->parameters = expr->parameters;
-    res->env = env;
+    res->env = closure(expr, env);
     res->body = expr->body;
 
     return res;
@@ -188,6 +279,12 @@ auto Eval::eval(std::shared_ptr<Node> node, std::shared_ptr<Environment> &env)
     return loop(std::move(expr), new_env);
   }
 
+  case ASTType::FORIN: {
+    auto new_env = std::make_shared<Environment>(env);
+    auto expr = ast::cast<Node, ForInExpression>(std::move(node));
+    return iterate(std::move(expr), new_env);
+  }
+
   case ASTType::RETURN: {
     auto stmt = ast::cast<Node, ReturnStatement>(std::move(node));
 
@@ -224,7 +321,7 @@ auto Eval::eval(std::shared_ptr<Node> node, std::shared_ptr<Environment> &env)
   }
 
   case ASTType::STRING: {
-    return std::make_shared<String>(
+    return strings->intern(
         ast::cast<Node, StringLiteral>(std::move(node))->value);
   }
 
@@ -236,8 +333,32 @@ auto Eval::eval(std::shared_ptr<Node> node, std::shared_ptr<Environment> &env)
       return error(expr->position(), elements[0]);
     }
 
-    auto res = std::make_shared<Array>();
-    res->elements = std::move(elements);
+    return std::make_shared<Array>(std::move(elements));
+  }
+
+  case ASTType::DICT: {
+    auto expr = ast::cast<Node, DictLiteral>(std::move(node));
+
+    auto res = std::make_shared<Dict>();
+    for (const auto &[key, value] : expr->pairs) {
+      auto k = eval(key, env);
+      if (auto err = error(key->position(), k); is_error(err)) {
+        return err;
+      }
+
+      if (!Dict::hashable(k)) {
+        return derror(key->position(),
+                      serror("expected an int, string or bool key"));
+      }
+
+      auto v = eval(value, env);
+      if (auto err = error(value->position(), v); is_error(err)) {
+        return err;
+      }
+
+      res->set(std::move(k), std::move(v));
+    }
+
     return res;
   }
 
@@ -250,6 +371,7 @@ auto Eval::program(this Eval &self, std::shared_ptr<Program> node,
                    std::shared_ptr<Environment> &env)
     -> const std::shared_ptr<Object> {
   auto result = OBJECT_NULL;
+  self.prefetch(node);
 
   for (auto &stmt : node->statements) {
     result = self.eval(std::move(stmt), env);
@@ -5,6 +5,7 @@
 #include <debug.hpp>
 #include <expected>
 #include <lexer.hpp>
+#include <list>
 #include <map>
 #include <memory>
 #include <object.hpp>
@@ -16,15 +17,71 @@ using namespace object;
 using namespace ast;
 
 namespace evaluator {
-const std::shared_ptr<Object> OBJECT_NULL = std::make_shared<Null>();
-const std::shared_ptr<Object> OBJECT_TRUE = std::make_shared<Bool>(true);
-const std::shared_ptr<Object> OBJECT_FALSE = std::make_shared<Bool>(false);
-
 auto is_error(const std::shared_ptr<Object> err) -> bool;
 
+// ---------------------------------------
+// MODULES
+struct Module {
+  string path;
+  string data;
+  std::unique_ptr<lexer::Lexer> lexer;
+  std::shared_ptr<Program> program;
+  std::vector<string> errors;
+  std::vector<string> imports;
+  std::shared_ptr<Environment> env;
+  bool evaluating = false;
+};
+
+// every module is lexed and parsed once per interpreter, modules
+// that do not depend on each other are parsed in parallel
+class Modules {
+public:
+  static auto resolve(const string &importer, const string &path) -> string;
+  auto get(this Modules &self, const string &path) -> std::shared_ptr<Module>;
+  auto prefetch(this Modules &self, std::vector<string> paths) -> void;
+  // the lexer of the module a source id belongs to, null when none does
+  auto lexer(this Modules &self, uint32_t source) -> lexer::Lexer *;
+
+private:
+  std::map<string, std::shared_ptr<Module>> loaded;
+};
+
+// regexes compiled once per interpreter, keyed by pattern. they keep
+// the dfa states built while matching, so reuse also saves those
+class Patterns {
+public:
+  // past this many patterns the cache starts over
+  static const size_t LIMIT = 256;
+
+  auto get(this Patterns &self, string_view pattern)
+      -> std::expected<std::shared_ptr<Regex>, string>;
+
+private:
+  std::map<string, std::shared_ptr<Regex>, std::less<>> compiled;
+};
+
+// a function called once per element by the higher order builtins.
+// a builtin is called through its fn with one argument list kept for
+// every call. a function whose body holds no function literal cannot
+// keep its frame alive past a call, so a single frame serves all the
+// calls and only its slots are rebound
+struct Caller {
+  std::shared_ptr<Object> fn;
+  std::shared_ptr<Builtin> builtin;
+  std::shared_ptr<Function> function;
+  // null when every call needs a frame of its own
+  std::shared_ptr<Environment> frame;
+  std::vector<std::shared_ptr<Slot>> params;
+  // filled in by the builtin before each call
+  std::vector<std::shared_ptr<Object>> args;
+  std::list<std::shared_ptr<Object>> list;
+};
+
 class Eval {
 public:
   Eval(lexer::Lexer &l);
+  Eval(lexer::Lexer &l, std::shared_ptr<Modules> modules,
+       std::shared_ptr<Strings> strings, std::shared_ptr<Patterns> patterns);
   auto eval(std::shared_ptr<Node> node, std::shared_ptr<Environment> &env)
       -> const std::shared_ptr<Object>;
 
@@ -42,6 +99,12 @@ private:
                std::shared_ptr<Environment> &env)
       -> const std::shared_ptr<Object>;
 
+  auto import_module(this Eval &self, std::shared_ptr<ImportStatement> node,
+                     std::shared_ptr<Environment> &env)
+      -> const std::shared_ptr<Object>;
+
+  auto prefetch(this Eval &self, std::shared_ptr<Program> node) -> void;
+
   auto identifier(this Eval &self, std::shared_ptr<Identifier> node,
                   std::shared_ptr<Environment> &env)
       -> const std::shared_ptr<Object>;
@@ -67,6 +130,31 @@ private:
                           std::shared_ptr<Environment> &env)
       -> const std::shared_ptr<Object>;
 
+  auto assignement_deque(this Eval &self, const std::shared_ptr<Deque> deque,
+                         std::shared_ptr<Expression> index,
+                         std::shared_ptr<Expression> value,
+                         std::shared_ptr<Environment> &env)
+      -> const std::shared_ptr<Object>;
+
+  auto assignement_bitset(this Eval &self,
+                          const std::shared_ptr<Bitset> bitset,
+                          std::shared_ptr<Expression> index,
+                          std::shared_ptr<Expression> value,
+                          std::shared_ptr<Environment> &env)
+      -> const std::shared_ptr<Object>;
+
+  auto assignement_dict(this Eval &self, const std::shared_ptr<Dict> dict,
+                        std::shared_ptr<Expression> index,
+                        std::shared_ptr<Expression> value,
+                        std::shared_ptr<Environment> &env)
+      -> const std::shared_ptr<Object>;
+
+  auto assignement_map(this Eval &self, const std::shared_ptr<OrderedMap> map,
+                       std::shared_ptr<Expression> index,
+                       std::shared_ptr<Expression> value,
+                       std::shared_ptr<Environment> &env)
+      -> const std::shared_ptr<Object>;
+
   auto assignment(this Eval &self, std::shared_ptr<AssignmentExpression> node,
                   std::shared_ptr<Environment> &env)
       -> const std::shared_ptr<Object>;
@@ -84,6 +172,9 @@ private:
       -> const std::shared_ptr<Object>;
   auto loop(this Eval &self, std::shared_ptr<ForExpression> node,
             std::shared_ptr<Environment> &env) -> const std::shared_ptr<Object>;
+  auto iterate(this Eval &self, std::shared_ptr<ForInExpression> node,
+               std::shared_ptr<Environment> &env)
+      -> const std::shared_ptr<Object>;
 
   auto expressions(this Eval &self,
                    const std::vector<std::shared_ptr<Expression>> &nodes,
@@ -92,7 +183,7 @@ private:
 
   auto infix(this Eval &self, token::Token op,
              const std::shared_ptr<Object> left,
-             const std::shared_ptr<Object> right)
+             const std::shared_ptr<Object> right, bool reuse = false)
       -> const std::shared_ptr<Object>;
 
   auto prefix(this Eval &self, token::Token op,
@@ -107,15 +198,25 @@ private:
 
   auto infix_op_integer(this Eval &self, token::Token op,
                         const std::shared_ptr<Object> left,
-                        const std::shared_ptr<Object> right)
+                        const std::shared_ptr<Object> right, bool reuse)
       -> const std::shared_ptr<Object>;
 
   auto infix_op_float(this Eval &self, token::Token op,
                       const std::shared_ptr<Object> left,
-                      const std::shared_ptr<Object> right)
+                      const std::shared_ptr<Object> right, bool reuse)
       -> const std::shared_ptr<Object>;
 
   auto infix_op_string(this Eval &self, token::Token op,
+                       const std::shared_ptr<Object> left,
+                       const std::shared_ptr<Object> right, bool reuse)
+      -> const std::shared_ptr<Object>;
+
+  auto infix_op_array(this Eval &self, token::Token op,
+                      const std::shared_ptr<Object> left,
+                      const std::shared_ptr<Object> right)
+      -> const std::shared_ptr<Object>;
+
+  auto infix_op_matrix(this Eval &self, token::Token op,
                        const std::shared_ptr<Object> left,
                        const std::shared_ptr<Object> right)
       -> const std::shared_ptr<Object>;
@@ -125,25 +226,65 @@ private:
       -> const std::shared_ptr<Object>;
 
   auto index_string(this Eval &self, const std::shared_ptr<Object> str,
+                    const std::shared_ptr<Object> index, bool escapes)
+      -> const std::shared_ptr<Object>;
+
+  auto index_deque(this Eval &self, const std::shared_ptr<Object> deque,
+                   const std::shared_ptr<Object> index)
+      -> const std::shared_ptr<Object>;
+
+  auto index_bitset(this Eval &self, const std::shared_ptr<Object> bitset,
+                    const std::shared_ptr<Object> index)
+      -> const std::shared_ptr<Object>;
+
+  auto index_matrix(this Eval &self, const std::shared_ptr<Object> matrix,
                     const std::shared_ptr<Object> index)
       -> const std::shared_ptr<Object>;
 
+  auto index_range(this Eval &self, const std::shared_ptr<Object> range,
+                   const std::shared_ptr<Object> index)
+      -> const std::shared_ptr<Object>;
+
+  auto index_dict(this Eval &self, const std::shared_ptr<Object> dict,
+                  const std::shared_ptr<Object> key)
+      -> const std::shared_ptr<Object>;
+
+  auto index_map(this Eval &self, const std::shared_ptr<Object> map,
+                 const std::shared_ptr<Object> key)
+      -> const std::shared_ptr<Object>;
+
   auto index(this Eval &self, const std::shared_ptr<Object> obj,
-             const std::shared_ptr<Object> index)
+             const std::shared_ptr<Object> index, bool escapes = true)
       -> const std::shared_ptr<Object>;
   auto assignment_operator(this Eval &self,
                            std::shared_ptr<AssignmentExpression> node,
                            token::Token op, std::shared_ptr<Environment> &env)
       -> const std::shared_ptr<Object>;
 
+  auto closure(this Eval &self, const std::shared_ptr<FunctionLiteral> node,
+               std::shared_ptr<Environment> &env)
+      -> std::shared_ptr<Environment>;
+
   auto extend_environment(this Eval &self, const std::shared_ptr<Function> fn,
                           const std::vector<std::shared_ptr<Object>> &args)
       -> std::shared_ptr<Environment>;
 
+  auto builtin(this Eval &self, const std::shared_ptr<Object> fn)
+      -> std::shared_ptr<Builtin>;
+
   auto function(this Eval &self, const std::shared_ptr<Object> fn,
                 const std::vector<std::shared_ptr<Object>> &args)
       -> const std::shared_ptr<Object>;
 
+  auto caller(this Eval &self, const std::shared_ptr<Object> fn, size_t arity)
+      -> std::expected<Caller, string>;
+
+  auto call(this Eval &self, Caller &caller) -> const std::shared_ptr<Object>;
+
+  auto before(this Eval &self, Caller &cmp, const std::shared_ptr<Object> &lhs,
+              const std::shared_ptr<Object> &rhs, std::shared_ptr<Object> &err)
+      -> bool;
+
   auto register_builtin_fn(string name, BuiltinFunction fn) -> void;
 
   auto builtin_fn_len(this Eval &self,
@@ -186,7 +327,242 @@ private:
                         const std::list<std::shared_ptr<Object>> &args)
       -> const std::shared_ptr<Object>;
 
+  auto builtin_fn_keys(this Eval &self,
+                       const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_has(this Eval &self,
+                      const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_remove(this Eval &self,
+                         const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_sum(this Eval &self,
+                      const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_min(this Eval &self,
+                      const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_max(this Eval &self,
+                      const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_mean(this Eval &self,
+                       const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_dot(this Eval &self,
+                      const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_mmap_array(this Eval &self,
+                             const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_omap(this Eval &self,
+                       const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_lower_bound(this Eval &self,
+                              const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_upper_bound(this Eval &self,
+                              const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_visit(this Eval &self,
+                        const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_pq(this Eval &self,
+                     const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_pq_push(this Eval &self,
+                          const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_pq_pop(this Eval &self,
+                         const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_pq_peek(this Eval &self,
+                          const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_deque(this Eval &self,
+                        const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_push_front(this Eval &self,
+                             const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_pop_front(this Eval &self,
+                            const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_bitset(this Eval &self,
+                         const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_popcount(this Eval &self,
+                           const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_bit_and(this Eval &self,
+                          const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_bit_or(this Eval &self,
+                         const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_bit_xor(this Eval &self,
+                          const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_bit_andnot(this Eval &self,
+                             const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_next_set(this Eval &self,
+                           const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_matrix(this Eval &self,
+                         const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_mat_get(this Eval &self,
+                          const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_mat_set(this Eval &self,
+                          const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_matmul(this Eval &self,
+                         const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_transpose(this Eval &self,
+                            const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_shape(this Eval &self,
+                        const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_sort(this Eval &self,
+                       const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_sort_by(this Eval &self,
+                          const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_map(this Eval &self,
+                      const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_filter(this Eval &self,
+                         const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_reduce(this Eval &self,
+                         const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_each(this Eval &self,
+                       const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_range(this Eval &self,
+                        const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_find(this Eval &self,
+                       const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_contains(this Eval &self,
+                           const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_split(this Eval &self,
+                        const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_join(this Eval &self,
+                       const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_replace(this Eval &self,
+                          const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_trim(this Eval &self,
+                       const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_re_compile(this Eval &self,
+                             const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_re_match(this Eval &self,
+                           const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_re_find_all(this Eval &self,
+                              const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_json_parse(this Eval &self,
+                             const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_json_stringify(
+      this Eval &self, const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_json_each(this Eval &self,
+                            const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_csv_read(this Eval &self,
+                           const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_csv_each(this Eval &self,
+                           const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_serialize(this Eval &self,
+                            const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_deserialize(this Eval &self,
+                              const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_read_file(this Eval &self,
+                            const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
+  auto builtin_fn_write_file(this Eval &self,
+                             const std::list<std::shared_ptr<Object>> &args)
+      -> const std::shared_ptr<Object>;
+
   lexer::Lexer &lexer;
+  std::shared_ptr<Modules> modules;
+  std::shared_ptr<Strings> strings;
+  std::shared_ptr<Patterns> patterns;
   std::map<string, std::shared_ptr<Builtin>> builinfns;
 };
 }; // namespace evaluator
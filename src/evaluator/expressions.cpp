@@ -1,10 +1,18 @@
+#include <array>
 #include <ast.hpp>
 #include <cstddef>
+#include <algorithm>
+#include <cstdint>
 #include <evaluator.hpp>
+#include <kernels.hpp>
 #include <memory>
 #include <object.hpp>
+#include <optional>
 #include <print>
+#include <span>
 #include <token.hpp>
+#include <type_traits>
+#include <vector>
 
 using namespace ast;
 using namespace object;
@@ -32,32 +40,47 @@ auto Eval::expressions(this Eval &self,
 
 auto Eval::infix(this Eval &self, token::Token op,
                  const std::shared_ptr<Object> left,
-                 const std::shared_ptr<Object> right)
+                 const std::shared_ptr<Object> right, bool reuse)
     -> const std::shared_ptr<Object> {
   if (left->type() == ObjectType::OINT && right->type() == ObjectType::OINT) {
-    return self.infix_op_integer(op, std::move(left), std::move(right));
+    return self.infix_op_integer(op, std::move(left), std::move(right), reuse);
   }
 
   if (left->type() == ObjectType::OFLOAT &&
       right->type() == ObjectType::OFLOAT) {
-    return self.infix_op_float(op, std::move(left), std::move(right));
+    return self.infix_op_float(op, std::move(left), std::move(right), reuse);
   }
 
   if (left->type() == ObjectType::OSTRING &&
       right->type() == ObjectType::OSTRING) {
-    return self.infix_op_string(op, std::move(left), std::move(right));
+    return self.infix_op_string(op, std::move(left), std::move(right), reuse);
   }
 
-  if (left->type() != right->type()) {
-    return self.serror("type mismatch");
+  if ((left->type() == ObjectType::OMATRIX ||
+       right->type() == ObjectType::OMATRIX) &&
+      (op == Token::TADD || op == Token::TSUB || op == Token::TMUL ||
+       op == Token::TDIV)) {
+    return self.infix_op_matrix(op, std::move(left), std::move(right));
   }
 
-  if (op == token::Token::TEQL) {
-    return self.boolean(left == right);
+  if ((left->type() == ObjectType::OARRAY ||
+       right->type() == ObjectType::OARRAY) &&
+      (op == Token::TADD || op == Token::TSUB || op == Token::TMUL ||
+       op == Token::TDIV)) {
+    return self.infix_op_array(op, std::move(left), std::move(right));
+  }
+
+  if (left->type() != right->type()) {
+    return self.serror("type mismatch");
   }
 
-  if (op == token::Token::TNEQL) {
-    return self.boolean(left != right);
+  if (op == token::Token::TEQL || op == token::Token::TNEQL) {
+    // nulls and bools are equal by value, not only the shared ones
+    auto same = left == right || left->type() == ObjectType::ONULL ||
+                (left->type() == ObjectType::OBOOL &&
+                 static_cast<const Bool &>(*left).value ==
+                     static_cast<const Bool &>(*right).value);
+    return self.boolean(same == (op == token::Token::TEQL));
   }
 
   return self.serror("unknown operator");
@@ -80,19 +103,7 @@ auto Eval::prefix(this Eval &self, token::Token op,
 
 auto Eval::op_not(this Eval &self, const std::shared_ptr<Object> right)
     -> const std::shared_ptr<Object> {
-  if (right->debug() == OBJECT_TRUE->debug()) {
-    return OBJECT_FALSE;
-  }
-
-  if (right->debug() == OBJECT_FALSE->debug()) {
-    return OBJECT_TRUE;
-  }
-
-  if (right->debug() == OBJECT_NULL->debug()) {
-    return OBJECT_TRUE;
-  }
-
-  return OBJECT_FALSE;
+  return self.boolean(!self.truthy(right));
 }
 
 auto Eval::op_sub(this Eval &self, const std::shared_ptr<Object> right)
@@ -117,11 +128,12 @@ auto Eval::op_sub(this Eval &self, const std::shared_ptr<Object> right)
 
 auto Eval::infix_op_integer(this Eval &self, token::Token op,
                             const std::shared_ptr<Object> left,
-                            const std::shared_ptr<Object> right)
+                            const std::shared_ptr<Object> right, bool reuse)
     -> const std::shared_ptr<Object> {
-  auto lval = object::cast<Object, Integer>(std::move(left))->value;
+  auto lobj = object::cast<Object, Integer>(std::move(left));
+  auto lval = lobj->value;
   auto rval = object::cast<Object, Integer>(std::move(right))->value;
-  auto res = std::make_shared<Integer>();
+  auto res = reuse ? std::move(lobj) : std::make_shared<Integer>();
 
   switch (op) {
   case Token::TADD:
@@ -167,11 +179,12 @@ auto Eval::infix_op_integer(this Eval &self, token::Token op,
 
 auto Eval::infix_op_float(this Eval &self, token::Token op,
                           const std::shared_ptr<Object> left,
-                          const std::shared_ptr<Object> right)
+                          const std::shared_ptr<Object> right, bool reuse)
     -> const std::shared_ptr<Object> {
-  auto lval = object::cast<Object, Float>(std::move(left))->value;
+  auto lobj = object::cast<Object, Float>(std::move(left));
+  auto lval = lobj->value;
   auto rval = object::cast<Object, Float>(std::move(right))->value;
-  auto res = std::make_shared<Float>();
+  auto res = reuse ? std::move(lobj) : std::make_shared<Float>();
 
   switch (op) {
   case Token::TADD:
@@ -215,18 +228,39 @@ auto Eval::infix_op_float(this Eval &self, token::Token op,
   return res;
 }
 
+// interned strings are unique per content, comparing them is a
+// pointer compare
+static auto string_equal(const std::shared_ptr<String> &left,
+                         const std::shared_ptr<String> &right) -> bool {
+  if (left == right) {
+    return true;
+  }
+
+  if (left->interned() && right->interned()) {
+    return false;
+  }
+
+  return left->view() == right->view();
+}
+
 auto Eval::infix_op_string(this Eval &self, token::Token op,
                            const std::shared_ptr<Object> left,
-                           const std::shared_ptr<Object> right)
+                           const std::shared_ptr<Object> right, bool reuse)
     -> const std::shared_ptr<Object> {
-  auto lval = object::cast<Object, String>(std::move(left))->value;
-  auto rval = object::cast<Object, String>(std::move(right))->value;
-  auto res = std::make_shared<String>();
+  auto lobj = object::cast<Object, String>(std::move(left));
+  auto robj = object::cast<Object, String>(std::move(right));
+  auto lval = lobj->view();
+  auto rval = robj->view();
 
   switch (op) {
-  case Token::TADD:
-    res->value = lval + rval;
-    break;
+  case Token::TADD: {
+    if (reuse && !lobj->interned()) {
+      lobj->append(rval);
+      return lobj;
+    }
+
+    return lobj->concat(rval);
+  }
 
   case Token::TGRT:
     return self.boolean(lval > rval);
@@ -241,16 +275,154 @@ auto Eval::infix_op_string(this Eval &self, token::Token op,
     return self.boolean(lval <= rval);
 
   case Token::TEQL:
-    return self.boolean(lval == rval);
+    return self.boolean(string_equal(lobj, robj));
 
   case Token::TNEQL:
-    return self.boolean(lval != rval);
+    return self.boolean(!string_equal(lobj, robj));
 
   default:
     return self.serror("unknown operator");
   }
+}
 
-  return res;
+static auto kernel_op(Token op) -> std::optional<kernels::Op> {
+  switch (op) {
+  case Token::TADD:
+    return kernels::Op::ADD;
+
+  case Token::TSUB:
+    return kernels::Op::SUB;
+
+  case Token::TMUL:
+    return kernels::Op::MUL;
+
+  case Token::TDIV:
+    return kernels::Op::DIV;
+
+  default:
+    return std::nullopt;
+  }
+}
+
+// an int or float operand of array arithmetic seen as packed values,
+// scalars become a single element the kernels broadcast
+template <typename T>
+static auto operand(const std::shared_ptr<Object> &obj, T &scalar)
+    -> std::optional<std::span<const T>> {
+  if (obj->type() == ObjectType::OARRAY) {
+    auto arr = object::cast<Object, Array>(obj);
+    if (arr->size() == 0) {
+      return std::span<const T>();
+    }
+
+    if constexpr (std::is_same_v<T, int64_t>) {
+      return arr->ints();
+    } else {
+      return arr->floats();
+    }
+  }
+
+  if constexpr (std::is_same_v<T, int64_t>) {
+    if (obj->type() != ObjectType::OINT) {
+      return std::nullopt;
+    }
+    scalar = object::cast<Object, Integer>(obj)->value;
+  } else {
+    if (obj->type() != ObjectType::OFLOAT) {
+      return std::nullopt;
+    }
+    scalar = object::cast<Object, Float>(obj)->value;
+  }
+  return std::span<const T>(&scalar, 1);
+}
+
+auto Eval::infix_op_array(this Eval &self, token::Token op,
+                          const std::shared_ptr<Object> left,
+                          const std::shared_ptr<Object> right)
+    -> const std::shared_ptr<Object> {
+  auto kop = kernel_op(op);
+  if (!kop.has_value()) {
+    return self.serror("unknown operator");
+  }
+
+  auto arr = object::cast<Object, Array>(
+      left->type() == ObjectType::OARRAY ? left : right);
+  if (left->type() == right->type() &&
+      object::cast<Object, Array>(left)->size() !=
+          object::cast<Object, Array>(right)->size()) {
+    return self.serror("array length mismatch");
+  }
+
+  int64_t lint = 0, rint = 0;
+  if (auto l = operand(left, lint), r = operand(right, rint); l && r) {
+    if (*kop == kernels::Op::DIV && std::ranges::find(*r, 0) != r->end()) {
+      return self.serror("division by zero");
+    }
+
+    auto res = Array::Ints(arr->size());
+    kernels::apply(*kop, *l, *r, res);
+    return std::make_shared<Array>(std::move(res));
+  }
+
+  double lfloat = 0, rfloat = 0;
+  if (auto l = operand(left, lfloat), r = operand(right, rfloat); l && r) {
+    auto res = Array::Floats(arr->size());
+    kernels::apply(*kop, *l, *r, res);
+    return std::make_shared<Array>(std::move(res));
+  }
+
+  return self.serror("type mismatch");
+}
+
+// element-wise, against a matrix of the same shape or a scalar
+auto Eval::infix_op_matrix(this Eval &self, token::Token op,
+                           const std::shared_ptr<Object> left,
+                           const std::shared_ptr<Object> right)
+    -> const std::shared_ptr<Object> {
+  auto kop = kernel_op(op);
+  if (!kop.has_value()) {
+    return self.serror("unknown operator");
+  }
+
+  auto values = [](const std::shared_ptr<Object> &obj, double &scalar)
+      -> std::optional<std::span<const double>> {
+    switch (obj->type()) {
+    case ObjectType::OMATRIX:
+      return object::cast<Object, Matrix>(obj)->values();
+
+    case ObjectType::OINT:
+      scalar = object::cast<Object, Integer>(obj)->value;
+      return std::span<const double>(&scalar, 1);
+
+    case ObjectType::OFLOAT:
+      scalar = object::cast<Object, Float>(obj)->value;
+      return std::span<const double>(&scalar, 1);
+
+    default:
+      return std::nullopt;
+    }
+  };
+
+  auto mat = object::cast<Object, Matrix>(
+      left->type() == ObjectType::OMATRIX ? left : right);
+  if (left->type() == right->type()) {
+    auto other = object::cast<Object, Matrix>(
+        left->type() == ObjectType::OMATRIX ? right : left);
+    if (mat->rows() != other->rows() || mat->cols() != other->cols()) {
+      return self.serror("matrix shape mismatch");
+    }
+  }
+
+  double lscalar = 0, rscalar = 0;
+  auto l = values(left, lscalar);
+  auto r = values(right, rscalar);
+  if (!l || !r) {
+    return self.serror("type mismatch");
+  }
+
+  auto res = std::vector<double>(mat->values().size());
+  kernels::apply(*kop, *l, *r, res);
+  return std::make_shared<Matrix>(mat->rows(), mat->cols(), std::move(res));
 }
 
 auto Eval::index_array(this Eval &self, const std::shared_ptr<Object> arr,
@@ -259,31 +431,143 @@ auto Eval::index_array(this Eval &self, const std::shared_ptr<Object> arr,
   auto obj = object::cast<Object, Array>(std::move(arr));
   auto idx = object::cast<Object, Integer>(std::move(index))->value;
 
-  if (idx < 0 || (size_t)idx >= obj->elements.size()) {
+  if (idx < 0 || (size_t)idx >= obj->size()) {
     return self.serror("index out of range");
   }
 
-  return obj->elements[idx];
+  return obj->at(idx);
 }
 
-auto Eval::index_string(this Eval &self, const std::shared_ptr<Object> arr,
+auto Eval::index_deque(this Eval &self, const std::shared_ptr<Object> deque,
+                       const std::shared_ptr<Object> index)
+    -> const std::shared_ptr<Object> {
+  auto obj = object::cast<Object, Deque>(std::move(deque));
+  auto idx = object::cast<Object, Integer>(std::move(index))->value;
+
+  if (idx < 0 || (size_t)idx >= obj->size()) {
+    return self.serror("index out of range");
+  }
+
+  return obj->at(idx);
+}
+
+auto Eval::index_bitset(this Eval &self, const std::shared_ptr<Object> bitset,
                         const std::shared_ptr<Object> index)
     -> const std::shared_ptr<Object> {
+  auto obj = object::cast<Object, Bitset>(std::move(bitset));
+  auto idx = object::cast<Object, Integer>(std::move(index))->value;
+
+  if (idx < 0 || (size_t)idx >= obj->size()) {
+    return self.serror("index out of range");
+  }
+
+  return self.boolean(obj->test(idx));
+}
+
+// a copy of row i as a float array
+auto Eval::index_matrix(this Eval &self, const std::shared_ptr<Object> matrix,
+                        const std::shared_ptr<Object> index)
+    -> const std::shared_ptr<Object> {
+  auto obj = object::cast<Object, Matrix>(std::move(matrix));
+  auto idx = object::cast<Object, Integer>(std::move(index))->value;
+
+  if (idx < 0 || (size_t)idx >= obj->rows()) {
+    return self.serror("index out of range");
+  }
+
+  auto row = obj->values().subspan(idx * obj->cols(), obj->cols());
+  return std::make_shared<Array>(Array::Floats(row.begin(), row.end()));
+}
+
+auto Eval::index_range(this Eval &self, const std::shared_ptr<Object> range,
+                       const std::shared_ptr<Object> index)
+    -> const std::shared_ptr<Object> {
+  auto obj = object::cast<Object, Range>(std::move(range));
+  auto idx = object::cast<Object, Integer>(std::move(index))->value;
+
+  if (idx < 0 || (size_t)idx >= obj->size()) {
+    return self.serror("index out of range");
+  }
+
+  return std::make_shared<Integer>(obj->at(idx));
+}
+
+// shared one character strings handed out for indexing results that
+// never escape, nothing can mutate them through a variable
+static auto character(char c) -> const std::shared_ptr<Object> & {
+  static const auto table = [] {
+    std::array<std::shared_ptr<Object>, 256> res;
+    for (size_t i = 0; i < res.size(); i++) {
+      res[i] = std::make_shared<String>(string(1, static_cast<char>(i)));
+    }
+    return res;
+  }();
+  return table[static_cast<uint8_t>(c)];
+}
+
+auto Eval::index_string(this Eval &self, const std::shared_ptr<Object> arr,
+                        const std::shared_ptr<Object> index, bool escapes)
+    -> const std::shared_ptr<Object> {
   auto obj = object::cast<Object, String>(std::move(arr));
   auto idx = object::cast<Object, Integer>(std::move(index))->value;
 
-  if (idx < 0 || (size_t)idx >= obj->value.length()) {
+  if (idx < 0 || (size_t)idx >= obj->size()) {
     return self.serror("index out of range");
   }
 
-  auto res = std::make_shared<String>();
-  res->value = obj->value[idx];
+  if (!escapes) {
+    return character(obj->view()[idx]);
+  }
+
+  return std::make_shared<String>(string(1, obj->view()[idx]));
+}
+
+auto Eval::index_dict(this Eval &self, const std::shared_ptr<Object> dict,
+                      const std::shared_ptr<Object> key)
+    -> const std::shared_ptr<Object> {
+  if (!Dict::hashable(key)) {
+    return self.serror("expected an int, string or bool key");
+  }
+
+  auto res = object::cast<Object, Dict>(std::move(dict))->get(key);
+  if (!res) {
+    return self.serror("key not found");
+  }
+
+  return res;
+}
+
+auto Eval::index_map(this Eval &self, const std::shared_ptr<Object> map,
+                     const std::shared_ptr<Object> key)
+    -> const std::shared_ptr<Object> {
+  if (!OrderedMap::orderable(key)) {
+    return self.serror("expected an int, float or string key");
+  }
+
+  auto obj = object::cast<Object, OrderedMap>(std::move(map));
+  if (!obj->accepts(key)) {
+    return self.serror("key type mismatch");
+  }
+
+  auto res = obj->get(key);
+  if (!res) {
+    return self.serror("key not found");
+  }
+
   return res;
 }
 
 auto Eval::index(this Eval &self, const std::shared_ptr<Object> obj,
-                 const std::shared_ptr<Object> index)
+                 const std::shared_ptr<Object> index, bool escapes)
     -> const std::shared_ptr<Object> {
+  if (obj->type() == ObjectType::ODICT) {
+    return self.index_dict(std::move(obj), std::move(index));
+  }
+
+  if (obj->type() == ObjectType::OMAP) {
+    return self.index_map(std::move(obj), std::move(index));
+  }
+
   if (index->type() != ObjectType::OINT) {
     return self.serror("expected an int type for index");
   }
@@ -294,11 +578,27 @@ auto Eval::index(this Eval &self, const std::shared_ptr<Object> obj,
   }
 
   case ObjectType::OSTRING: {
-    return self.index_string(std::move(obj), std::move(index));
+    return self.index_string(std::move(obj), std::move(index), escapes);
+  }
+
+  case ObjectType::ODEQUE: {
+    return self.index_deque(std::move(obj), std::move(index));
+  }
+
+  case ObjectType::OBITSET: {
+    return self.index_bitset(std::move(obj), std::move(index));
+  }
+
+  case ObjectType::OMATRIX: {
+    return self.index_matrix(std::move(obj), std::move(index));
+  }
+
+  case ObjectType::ORANGE: {
+    return self.index_range(std::move(obj), std::move(index));
   }
 
   default:
-    return self.serror("expected an array or string type");
+    return self.serror("expected an indexable type");
   }
 }
 
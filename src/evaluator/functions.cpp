@@ -1,4 +1,7 @@
+#include <algorithm>
+#include <analysis.hpp>
 #include <evaluator.hpp>
+#include <expected>
 #include <format>
 #include <list>
 #include <memory>
@@ -10,6 +13,29 @@ using namespace ast;
 using namespace object;
 using namespace evaluator;
 
+auto Eval::closure(this Eval &self, const std::shared_ptr<FunctionLiteral> node,
+                   std::shared_ptr<Environment> &env)
+    -> std::shared_ptr<Environment> {
+  auto res = std::make_shared<Environment>();
+  for (const auto &name : node->captures) {
+    if (auto slot = env->slot(name); slot) {
+      res->bind(name, std::move(slot));
+      continue;
+    }
+
+    if (self.builinfns.contains(name) ||
+        std::ranges::binary_search(node->locals, name)) {
+      continue;
+    }
+
+    // referenced before it is declared anywhere, keep the whole
+    // chain so the name resolves once it exists
+    return env;
+  }
+
+  return res;
+}
+
 auto Eval::extend_environment(this Eval &self,
                               const std::shared_ptr<Function> fn,
                               const std::vector<std::shared_ptr<Object>> &args)
@@ -21,6 +47,14 @@ auto Eval::extend_environment(this Eval &self,
   return env;
 }
 
+// a builtin held in a variable can outlive the interpreter that made it,
+// a module's or an earlier repl line's, and its fn points back at that
+// interpreter. calls go to the running one's builtin of the same name
+auto Eval::builtin(this Eval &self, const std::shared_ptr<Object> fn)
+    -> std::shared_ptr<Builtin> {
+  return self.builinfns.at(object::cast<Object, Builtin>(fn)->name);
+}
+
 auto Eval::function(this Eval &self, const std::shared_ptr<Object> fn,
                     const std::vector<std::shared_ptr<Object>> &args)
     -> const std::shared_ptr<Object> {
@@ -34,6 +68,9 @@ auto Eval::function(this Eval &self, const std::shared_ptr<Object> fn,
 
     auto func_env = self.extend_environment(func, args);
     auto res = self.eval(func->body, func_env);
+    if (!res) {
+      return OBJECT_NULL;
+    }
 
     if (res->type() == ObjectType::ORETURNVAL) {
       return object::cast<Object, ReturnValue>(std::move(res))->value;
@@ -43,7 +80,7 @@ auto Eval::function(this Eval &self, const std::shared_ptr<Object> fn,
   }
 
   case ObjectType::OBUILTINFUNCTION: {
-    auto func = object::cast<Object, Builtin>(fn);
+    auto func = self.builtin(fn);
     return func->fn(std::list(args.begin(), args.end()));
   }
 
@@ -51,3 +88,73 @@ auto Eval::function(this Eval &self, const std::shared_ptr<Object> fn,
     return self.serror("undefined or not a function");
   }
 }
+
+auto Eval::caller(this Eval &self, const std::shared_ptr<Object> fn,
+                  size_t arity) -> std::expected<Caller, string> {
+  auto res = Caller();
+  res.fn = fn;
+  res.args.resize(arity);
+
+  switch (fn->type()) {
+  case ObjectType::OBUILTINFUNCTION:
+    res.builtin = self.builtin(fn);
+    res.list.resize(arity);
+    return res;
+
+  case ObjectType::OFUNCTION: {
+    res.function = object::cast<Object, Function>(fn);
+    if (res.function->parameters.size() != arity) {
+      return std::unexpected(
+          std::format("expected a function of {} arguments but got {}",
+                      arity, res.function->parameters.size()));
+    }
+
+    if (analysis::closes(res.function->body)) {
+      return res;
+    }
+
+    res.frame = self.extend_environment(res.function, res.args);
+    for (const auto &parm : res.function->parameters) {
+      res.params.push_back(res.frame->slot(parm->value));
+    }
+    return res;
+  }
+
+  default:
+    return std::unexpected("expected a function type");
+  }
+}
+
+auto Eval::call(this Eval &self, Caller &caller)
+    -> const std::shared_ptr<Object> {
+  if (caller.builtin) {
+    std::ranges::copy(caller.args, caller.list.begin());
+    return caller.builtin->fn(caller.list);
+  }
+
+  if (!caller.frame) {
+    return self.function(caller.fn, caller.args);
+  }
+
+  // names the last call declared with let are unbound so the body can
+  // declare them again
+  for (const auto &[name, slot] : caller.frame->entries()) {
+    slot->bound = false;
+    slot->value = nullptr;
+  }
+  for (size_t i = 0; i < caller.params.size(); i++) {
+    caller.params[i]->value = caller.args[i];
+    caller.params[i]->bound = true;
+  }
+
+  auto res = self.eval(caller.function->body, caller.frame);
+  if (!res) {
+    return OBJECT_NULL;
+  }
+
+  if (res->type() == ObjectType::ORETURNVAL) {
+    return object::cast<Object, ReturnValue>(std::move(res))->value;
+  }
+
+  return res;
+}
@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <ast.hpp>
+#include <cache.hpp>
+#include <evaluator.hpp>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <future>
+#include <lexer.hpp>
+#include <memory>
+#include <object.hpp>
+#include <parser.hpp>
+#include <sstream>
+#include <thread>
+
+using namespace ast;
+using namespace object;
+using namespace evaluator;
+
+namespace fs = std::filesystem;
+
+auto Modules::resolve(const string &importer, const string &path) -> string {
+  auto res = fs::path(importer).parent_path() / path;
+  std::error_code ec;
+  auto canonical = fs::weakly_canonical(res, ec);
+  if (ec) {
+    return res.lexically_normal().string();
+  }
+  return canonical.string();
+}
+
+// runs on a worker thread, touches nothing but the new module
+static auto parse_module(const string &path) -> std::shared_ptr<Module> {
+  auto module = std::make_shared<Module>();
+  module->path = path;
+
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    module->errors.push_back(
+        std::format("eta: \u001b[31mfailed to open module {}\033[0m\n", path));
+    return module;
+  }
+
+  std::ostringstream ss;
+  ss << file.rdbuf();
+  module->data = ss.str();
+  module->lexer = std::make_unique<lexer::Lexer>(module->path, module->data);
+
+  module->program = cache::load(module->data, module->lexer->get_source());
+  if (!module->program) {
+    auto parser = parser::Parser(*module->lexer);
+    module->program = parser.parse();
+    module->errors = parser.get_errors();
+    if (!module->errors.empty()) {
+      return module;
+    }
+    cache::store(module->data, module->program);
+  }
+
+  for (const auto &stmt : module->program->statements) {
+    if (stmt->type() == ASTType::IMPORT) {
+      auto decl = ast::cast<Statement, ImportStatement>(stmt);
+      module->imports.push_back(Modules::resolve(module->path, decl->path));
+    }
+  }
+
+  return module;
+}
+
+auto Modules::prefetch(this Modules &self, std::vector<string> paths) -> void {
+  auto workers = std::max<size_t>(1, std::thread::hardware_concurrency());
+
+  // walk the dependency graph level by level, every module of
+  // a level is independent of the others and parsed concurrently
+  while (!paths.empty()) {
+    std::ranges::sort(paths);
+    auto [first, last] = std::ranges::unique(paths);
+    paths.erase(first, last);
+    std::erase_if(paths, [&](const string &p) {
+      return self.loaded.contains(p);
+    });
+
+    std::vector<string> next;
+    for (size_t i = 0; i < paths.size(); i += workers) {
+      std::vector<std::future<std::shared_ptr<Module>>> jobs;
+      for (size_t j = i; j < std::min(paths.size(), i + workers); j++) {
+        jobs.push_back(std::async(std::launch::async, parse_module, paths[j]));
+      }
+
+      for (auto &job : jobs) {
+        auto module = job.get();
+        next.insert(next.end(), module->imports.begin(),
+                    module->imports.end());
+        self.loaded[module->path] = std::move(module);
+      }
+    }
+
+    paths = std::move(next);
+  }
+}
+
+auto Modules::get(this Modules &self, const string &path)
+    -> std::shared_ptr<Module> {
+  if (!self.loaded.contains(path)) {
+    self.prefetch({path});
+  }
+
+  return self.loaded.at(path);
+}
+
+auto Modules::lexer(this Modules &self, uint32_t source) -> lexer::Lexer * {
+  for (const auto &[path, module] : self.loaded) {
+    if (module->lexer && module->lexer->get_source() == source) {
+      return module->lexer.get();
+    }
+  }
+
+  return nullptr;
+}
+
+auto Eval::prefetch(this Eval &self, std::shared_ptr<Program> node) -> void {
+  std::vector<string> paths;
+  for (const auto &stmt : node->statements) {
+    if (stmt && stmt->type() == ASTType::IMPORT) {
+      auto decl = ast::cast<Statement, ImportStatement>(stmt);
+      paths.push_back(
+          Modules::resolve(self.lexer.get_filename(), decl->path));
+    }
+  }
+
+  if (!paths.empty()) {
+    self.modules->prefetch(std::move(paths));
+  }
+}
+
+auto Eval::import_module(this Eval &self,
+                         std::shared_ptr<ImportStatement> node,
+                         std::shared_ptr<Environment> &env)
+    -> const std::shared_ptr<Object> {
+  auto module = self.modules->get(
+      Modules::resolve(self.lexer.get_filename(), node->path));
+
+  if (!module->errors.empty()) {
+    auto res = std::make_shared<DetailedError>();
+    for (const auto &e : module->errors) {
+      res->value += e;
+    }
+    return res;
+  }
+
+  if (module->evaluating) {
+    return self.derror(node->position(), self.serror("circular import"));
+  }
+
+  if (!module->env) {
+    auto module_env = std::make_shared<Environment>();
+    auto eval =
+        Eval(*module->lexer, self.modules, self.strings, self.patterns);
+
+    module->evaluating = true;
+    auto res = eval.eval(module->program, module_env);
+    module->evaluating = false;
+    if (is_error(res)) {
+      // the program has been consumed, later imports report the same error
+      module->errors.push_back(res->debug());
+      return res;
+    }
+
+    module->env = std::move(module_env);
+  }
+
+  // names starting with an underscore stay private to the module
+  for (const auto &[name, slot] : module->env->entries()) {
+    if (name.starts_with('_') || !slot->bound) {
+      continue;
+    }
+
+    if (env->exists(name)) {
+      if (env->slot(name) == slot) {
+        continue;
+      }
+
+      return self.derror(
+          node->position(),
+          self.serror(std::format("import redeclares variable {}", name)));
+    }
+
+    env->bind(name, slot);
+  }
+
+  return OBJECT_NULL;
+}
@@ -0,0 +1,50 @@
+#ifndef __ETA_JSON_HPP__
+#define __ETA_JSON_HPP__
+
+#include <cstddef>
+#include <expected>
+#include <fstream>
+#include <memory>
+#include <object.hpp>
+#include <string>
+#include <string_view>
+
+using std::string;
+using std::string_view;
+
+// json text to and from eta objects. objects become dicts, numbers
+// become ints when they are integral and fit in 64 bits and floats
+// otherwise, arrays of numbers are parsed straight into packed storage
+namespace json {
+const size_t MAX_DEPTH = 512;
+
+auto parse(string_view text)
+    -> std::expected<std::shared_ptr<object::Object>, string>;
+auto stringify(const std::shared_ptr<object::Object> &value)
+    -> std::expected<string, string>;
+
+// the top-level values of a file one at a time, as in ndjson. the file
+// is read in chunks and only the value being parsed is kept in memory
+class Stream {
+public:
+  static constexpr size_t CHUNK = 1 << 20;
+
+  static auto open(const string &path) -> std::expected<Stream, string>;
+  // the next value, nullptr once the file is over
+  auto next(this Stream &self)
+      -> std::expected<std::shared_ptr<object::Object>, string>;
+
+private:
+  Stream(std::ifstream file);
+  auto fill(this Stream &self) -> void;
+
+  std::ifstream file;
+  string buffer;
+  // parsed up to pos in buffer, buffer starts offset bytes into the file
+  size_t pos;
+  size_t offset;
+  bool eof;
+};
+}; // namespace json
+
+#endif
@@ -0,0 +1,532 @@
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <format>
+#include <fstream>
+#include <json.hpp>
+#include <kernels.hpp>
+#include <memory>
+#include <object.hpp>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+
+using namespace object;
+
+namespace {
+using Number = std::variant<int64_t, double>;
+
+// recursive descent over the text. string bodies, where most of the
+// bytes usually are, are skipped with the simd scanner up to the next
+// quote or backslash
+class Parser {
+public:
+  // with partial set the text may continue past its end, so running
+  // out of it sets incomplete instead of being a plain syntax error
+  Parser(string_view text, bool partial, size_t base)
+      : text(text), partial(partial), base(base) {}
+
+  auto value(this Parser &self, size_t depth)
+      -> std::expected<std::shared_ptr<Object>, string> {
+    self.skip();
+    if (self.pos >= self.text.size()) {
+      return self.end();
+    }
+    if (depth > json::MAX_DEPTH) {
+      return self.fail("value nests too deeply");
+    }
+
+    switch (self.text[self.pos]) {
+    case '{':
+      return self.object(depth);
+
+    case '[':
+      return self.array(depth);
+
+    case '"': {
+      auto str = self.quoted();
+      if (!str.has_value()) {
+        return std::unexpected(str.error());
+      }
+      return std::make_shared<String>(std::move(str.value()));
+    }
+
+    case 't':
+      return self.literal("true", OBJECT_TRUE);
+
+    case 'f':
+      return self.literal("false", OBJECT_FALSE);
+
+    case 'n':
+      return self.literal("null", OBJECT_NULL);
+
+    default: {
+      auto num = self.number();
+      if (!num.has_value()) {
+        return std::unexpected(num.error());
+      }
+      if (auto *i = std::get_if<int64_t>(&num.value())) {
+        return std::make_shared<Integer>(*i);
+      }
+      return std::make_shared<Float>(std::get<double>(num.value()));
+    }
+    }
+  }
+
+  auto skip(this Parser &self) -> void {
+    while (self.pos < self.text.size()) {
+      auto c = self.text[self.pos];
+      if (c != ' ' && c != '\n' && c != '\r' && c != '\t') {
+        break;
+      }
+      self.pos++;
+    }
+  }
+
+  auto fail(this const Parser &self, string_view msg)
+      -> std::unexpected<string> {
+    return std::unexpected(std::format("invalid json, {} at offset {}", msg,
+                                       self.base + self.pos));
+  }
+
+  size_t pos = 0;
+  bool incomplete = false;
+
+private:
+  auto end(this Parser &self) -> std::unexpected<string> {
+    self.incomplete = true;
+    return self.fail("unexpected end of input");
+  }
+
+  auto literal(this Parser &self, string_view word,
+               std::shared_ptr<Object> res)
+      -> std::expected<std::shared_ptr<Object>, string> {
+    auto rest = self.text.substr(self.pos, word.size());
+    if (rest.size() < word.size() && word.starts_with(rest)) {
+      return self.end();
+    }
+    if (rest != word) {
+      return self.fail("unexpected character");
+    }
+    self.pos += word.size();
+    return res;
+  }
+
+  auto digits(this Parser &self) -> size_t {
+    auto start = self.pos;
+    while (self.pos < self.text.size() && self.text[self.pos] >= '0' &&
+           self.text[self.pos] <= '9') {
+      self.pos++;
+    }
+    return self.pos - start;
+  }
+
+  // -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+  auto number(this Parser &self) -> std::expected<Number, string> {
+    auto &text = self.text;
+    auto start = self.pos;
+    if (text[self.pos] == '-') {
+      self.pos++;
+    }
+    if (self.pos >= text.size()) {
+      return self.end();
+    }
+    if (text[self.pos] == '0') {
+      self.pos++;
+    } else if (self.digits() == 0) {
+      return self.fail("unexpected character");
+    }
+
+    auto integral = true;
+    if (self.pos < text.size() && text[self.pos] == '.') {
+      self.pos++;
+      integral = false;
+      if (self.digits() == 0) {
+        return self.pos >= text.size() ? self.end()
+                                        : self.fail("invalid number");
+      }
+    }
+    if (self.pos < text.size() &&
+        (text[self.pos] == 'e' || text[self.pos] == 'E')) {
+      self.pos++;
+      integral = false;
+      if (self.pos < text.size() &&
+          (text[self.pos] == '+' || text[self.pos] == '-')) {
+        self.pos++;
+      }
+      if (self.digits() == 0) {
+        return self.pos >= text.size() ? self.end()
+                                        : self.fail("invalid number");
+      }
+    }
+    // more digits may be on their way
+    if (self.pos >= text.size() && self.partial) {
+      return self.end();
+    }
+
+    auto *first = text.data() + start;
+    auto *last = text.data() + self.pos;
+    if (integral) {
+      int64_t i = 0;
+      if (std::from_chars(first, last, i).ec == std::errc()) {
+        return i;
+      }
+    }
+
+    double d = 0;
+    if (std::from_chars(first, last, d).ec != std::errc()) {
+      self.pos = start;
+      return self.fail("number out of range");
+    }
+    return d;
+  }
+
+  auto hex(this Parser &self) -> std::expected<uint32_t, string> {
+    if (self.pos + 4 > self.text.size()) {
+      return self.end();
+    }
+    uint32_t res = 0;
+    auto *first = self.text.data() + self.pos;
+    auto [ptr, ec] = std::from_chars(first, first + 4, res, 16);
+    if (ec != std::errc() || ptr != first + 4) {
+      return self.fail("invalid unicode escape");
+    }
+    self.pos += 4;
+    return res;
+  }
+
+  auto unicode(this Parser &self, string &out)
+      -> std::expected<void, string> {
+    auto cp = self.hex();
+    if (!cp.has_value()) {
+      return std::unexpected(cp.error());
+    }
+
+    auto code = cp.value();
+    if (code >= 0xDC00 && code <= 0xDFFF) {
+      return self.fail("invalid unicode escape");
+    }
+    if (code >= 0xD800 && code <= 0xDBFF) {
+      // a high surrogate pairs with the low one escaped right after it
+      if (self.pos + 2 > self.text.size()) {
+        return self.end();
+      }
+      if (self.text.substr(self.pos, 2) != "\\u") {
+        return self.fail("invalid unicode escape");
+      }
+      self.pos += 2;
+      auto low = self.hex();
+      if (!low.has_value()) {
+        return std::unexpected(low.error());
+      }
+      if (low.value() < 0xDC00 || low.value() > 0xDFFF) {
+        return self.fail("invalid unicode escape");
+      }
+      code = 0x10000 + ((code - 0xD800) << 10) + (low.value() - 0xDC00);
+    }
+
+    if (code < 0x80) {
+      out += static_cast<char>(code);
+    } else if (code < 0x800) {
+      out += static_cast<char>(0xC0 | (code >> 6));
+      out += static_cast<char>(0x80 | (code & 0x3F));
+    } else if (code < 0x10000) {
+      out += static_cast<char>(0xE0 | (code >> 12));
+      out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+      out += static_cast<char>(0x80 | (code & 0x3F));
+    } else {
+      out += static_cast<char>(0xF0 | (code >> 18));
+      out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+      out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+      out += static_cast<char>(0x80 | (code & 0x3F));
+    }
+    return {};
+  }
+
+  auto quoted(this Parser &self) -> std::expected<string, string> {
+    static const auto special = kernels::Scanner("\"\\");
+
+    self.pos++;
+    auto res = string();
+    for (;;) {
+      auto at = special.find(self.text, self.pos);
+      if (at == kernels::Scanner::NPOS) {
+        self.pos = self.text.size();
+        return self.end();
+      }
+      res.append(self.text.substr(self.pos, at - self.pos));
+      self.pos = at + 1;
+      if (self.text[at] == '"') {
+        return res;
+      }
+
+      if (self.pos >= self.text.size()) {
+        return self.end();
+      }
+      switch (self.text[self.pos++]) {
+      case '"':
+        res += '"';
+        break;
+      case '\\':
+        res += '\\';
+        break;
+      case '/':
+        res += '/';
+        break;
+      case 'b':
+        res += '\b';
+        break;
+      case 'f':
+        res += '\f';
+        break;
+      case 'n':
+        res += '\n';
+        break;
+      case 'r':
+        res += '\r';
+        break;
+      case 't':
+        res += '\t';
+        break;
+      case 'u': {
+        auto ok = self.unicode(res);
+        if (!ok.has_value()) {
+          return std::unexpected(ok.error());
+        }
+        break;
+      }
+      default:
+        self.pos--;
+        return self.fail("invalid escape");
+      }
+    }
+  }
+
+  // arrays stay packed while their elements are all ints or all floats,
+  // like Array::fit does
+  auto array(this Parser &self, size_t depth)
+      -> std::expected<std::shared_ptr<Object>, string> {
+    auto ints = Array::Ints();
+    auto floats = Array::Floats();
+    auto boxed = Array::Boxed();
+    enum { EMPTY, INTS, FLOATS, BOXED } kind = EMPTY;
+    auto box = [&] {
+      for (auto i : ints) {
+        boxed.push_back(std::make_shared<Integer>(i));
+      }
+      for (auto f : floats) {
+        boxed.push_back(std::make_shared<Float>(f));
+      }
+      ints.clear();
+      floats.clear();
+      kind = BOXED;
+    };
+
+    self.pos++;
+    self.skip();
+    if (self.pos < self.text.size() && self.text[self.pos] == ']') {
+      self.pos++;
+      return std::make_shared<Array>();
+    }
+
+    for (;;) {
+      self.skip();
+      if (self.pos >= self.text.size()) {
+        return self.end();
+      }
+
+      auto c = self.text[self.pos];
+      if (kind != BOXED && (c == '-' || (c >= '0' && c <= '9'))) {
+        auto num = self.number();
+        if (!num.has_value()) {
+          return std::unexpected(num.error());
+        }
+
+        if (auto *i = std::get_if<int64_t>(&num.value())) {
+          if (kind == FLOATS) {
+            box();
+            boxed.push_back(std::make_shared<Integer>(*i));
+          } else {
+            kind = INTS;
+            ints.push_back(*i);
+          }
+        } else {
+          auto f = std::get<double>(num.value());
+          if (kind == INTS) {
+            box();
+            boxed.push_back(std::make_shared<Float>(f));
+          } else {
+            kind = FLOATS;
+            floats.push_back(f);
+          }
+        }
+      } else {
+        auto e = self.value(depth + 1);
+        if (!e.has_value()) {
+          return e;
+        }
+        if (kind != BOXED) {
+          box();
+        }
+        boxed.push_back(std::move(e.value()));
+      }
+
+      self.skip();
+      if (self.pos >= self.text.size()) {
+        return self.end();
+      }
+      if (self.text[self.pos] == ']') {
+        self.pos++;
+        break;
+      }
+      if (self.text[self.pos] != ',') {
+        return self.fail("expected ',' or ']'");
+      }
+      self.pos++;
+    }
+
+    if (kind == INTS) {
+      return std::make_shared<Array>(std::move(ints));
+    }
+    if (kind == FLOATS) {
+      return std::make_shared<Array>(std::move(floats));
+    }
+    return std::make_shared<Array>(std::move(boxed));
+  }
+
+  auto object(this Parser &self, size_t depth)
+      -> std::expected<std::shared_ptr<Object>, string> {
+    auto res = std::make_shared<Dict>();
+    self.pos++;
+    self.skip();
+    if (self.pos < self.text.size() && self.text[self.pos] == '}') {
+      self.pos++;
+      return res;
+    }
+
+    for (;;) {
+      self.skip();
+      if (self.pos >= self.text.size()) {
+        return self.end();
+      }
+      if (self.text[self.pos] != '"') {
+        return self.fail("expected a string key");
+      }
+      auto key = self.quoted();
+      if (!key.has_value()) {
+        return std::unexpected(key.error());
+      }
+
+      self.skip();
+      if (self.pos >= self.text.size()) {
+        return self.end();
+      }
+      if (self.text[self.pos] != ':') {
+        return self.fail("expected ':'");
+      }
+      self.pos++;
+
+      auto value = self.value(depth + 1);
+      if (!value.has_value()) {
+        return value;
+      }
+      res->set(std::make_shared<String>(std::move(key.value())),
+               std::move(value.value()));
+
+      self.skip();
+      if (self.pos >= self.text.size()) {
+        return self.end();
+      }
+      if (self.text[self.pos] == '}') {
+        self.pos++;
+        return res;
+      }
+      if (self.text[self.pos] != ',') {
+        return self.fail("expected ',' or '}'");
+      }
+      self.pos++;
+    }
+  }
+
+  string_view text;
+  bool partial;
+  size_t base;
+};
+}; // namespace
+
+auto json::parse(string_view text)
+    -> std::expected<std::shared_ptr<Object>, string> {
+  auto parser = Parser(text, false, 0);
+  auto res = parser.value(0);
+  if (!res.has_value()) {
+    return res;
+  }
+
+  parser.skip();
+  if (parser.pos != text.size()) {
+    return parser.fail("unexpected character");
+  }
+  return res;
+}
+
+json::Stream::Stream(std::ifstream file)
+    : file(std::move(file)), pos(0), offset(0), eof(false) {}
+
+auto json::Stream::open(const string &path) -> std::expected<Stream, string> {
+  auto file = std::ifstream(path, std::ios::binary);
+  if (!file) {
+    return std::unexpected(std::format("cannot open file: {}", path));
+  }
+  return Stream(std::move(file));
+}
+
+// a value cut off by the end of the buffer is parsed again from its
+// start once more of the file is in
+auto json::Stream::next(this Stream &self)
+    -> std::expected<std::shared_ptr<Object>, string> {
+  for (;;) {
+    auto view = string_view(self.buffer).substr(self.pos);
+    auto parser = Parser(view, !self.eof, self.offset + self.pos);
+    parser.skip();
+    if (parser.pos == view.size()) {
+      if (self.eof) {
+        return nullptr;
+      }
+      self.pos = self.buffer.size();
+      self.fill();
+      continue;
+    }
+
+    auto res = parser.value(0);
+    if (res.has_value()) {
+      self.pos += parser.pos;
+      return res;
+    }
+    if (!parser.incomplete || self.eof) {
+      return res;
+    }
+    self.fill();
+  }
+}
+
+// drops what has been parsed and reads at least a chunk, as much as
+// the buffer already holds when a value spans several chunks so the
+// reparsing stays linear
+auto json::Stream::fill(this Stream &self) -> void {
+  self.buffer.erase(0, self.pos);
+  self.offset += self.pos;
+  self.pos = 0;
+
+  auto size = self.buffer.size();
+  auto want = std::max(CHUNK, size);
+  self.buffer.resize(size + want);
+  self.file.read(self.buffer.data() + size, want);
+  auto got = static_cast<size_t>(self.file.gcount());
+  self.buffer.resize(size + got);
+  if (got < want) {
+    self.eof = true;
+  }
+}
@@ -0,0 +1,187 @@
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <format>
+#include <json.hpp>
+#include <memory>
+#include <object.hpp>
+#include <string>
+#include <string_view>
+
+using namespace object;
+
+namespace {
+auto integer(string &out, int64_t value) -> void {
+  char buf[24];
+  auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), value);
+  out.append(buf, end);
+}
+
+// shortest text that reads back as the same double, with a ".0" added
+// to integral values so they come back as floats
+auto number(string &out, double value) -> std::expected<void, string> {
+  if (!std::isfinite(value)) {
+    return std::unexpected(std::format("cannot convert {} to json", value));
+  }
+
+  char buf[32];
+  auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), value);
+  auto text = string_view(buf, end);
+  out += text;
+  if (text.find_first_of(".e") == string_view::npos) {
+    out += ".0";
+  }
+  return {};
+}
+
+auto quote(string &out, string_view str) -> void {
+  static const char *HEX = "0123456789abcdef";
+
+  out += '"';
+  size_t run = 0;
+  for (size_t i = 0; i < str.size(); i++) {
+    auto c = static_cast<uint8_t>(str[i]);
+    if (c >= 0x20 && c != '"' && c != '\\') {
+      continue;
+    }
+
+    out.append(str.substr(run, i - run));
+    run = i + 1;
+    switch (c) {
+    case '"':
+      out += "\\\"";
+      break;
+    case '\\':
+      out += "\\\\";
+      break;
+    case '\n':
+      out += "\\n";
+      break;
+    case '\r':
+      out += "\\r";
+      break;
+    case '\t':
+      out += "\\t";
+      break;
+    case '\b':
+      out += "\\b";
+      break;
+    case '\f':
+      out += "\\f";
+      break;
+    default:
+      out += "\\u00";
+      out += HEX[c >> 4];
+      out += HEX[c & 0xF];
+    }
+  }
+  out.append(str.substr(run));
+  out += '"';
+}
+
+auto write(string &out, const std::shared_ptr<Object> &value, size_t depth)
+    -> std::expected<void, string> {
+  if (depth > json::MAX_DEPTH) {
+    return std::unexpected("value nests too deeply");
+  }
+
+  switch (value->type()) {
+  case ObjectType::ONULL:
+    out += "null";
+    return {};
+
+  case ObjectType::OBOOL:
+    out += object::cast<Object, Bool>(value)->value ? "true" : "false";
+    return {};
+
+  case ObjectType::OINT:
+    integer(out, object::cast<Object, Integer>(value)->value);
+    return {};
+
+  case ObjectType::OFLOAT:
+    return number(out, object::cast<Object, Float>(value)->value);
+
+  case ObjectType::OSTRING:
+    quote(out, object::cast<Object, String>(value)->view());
+    return {};
+
+  case ObjectType::OARRAY: {
+    auto arr = object::cast<Object, Array>(value);
+    out += '[';
+    if (auto ints = arr->ints()) {
+      for (size_t i = 0; i < ints->size(); i++) {
+        if (i != 0) {
+          out += ',';
+        }
+        integer(out, (*ints)[i]);
+      }
+    } else if (auto floats = arr->floats()) {
+      for (size_t i = 0; i < floats->size(); i++) {
+        if (i != 0) {
+          out += ',';
+        }
+        auto res = number(out, (*floats)[i]);
+        if (!res.has_value()) {
+          return res;
+        }
+      }
+    } else {
+      for (size_t i = 0; i < arr->size(); i++) {
+        if (i != 0) {
+          out += ',';
+        }
+        auto res = write(out, arr->at(i), depth + 1);
+        if (!res.has_value()) {
+          return res;
+        }
+      }
+    }
+    out += ']';
+    return {};
+  }
+
+  // json keys are strings, int and bool keys are written as their text
+  case ObjectType::ODICT: {
+    auto res = std::expected<void, string>();
+    auto first = true;
+    out += '{';
+    object::cast<Object, Dict>(value)->each(
+        [&](const auto &key, const auto &value) {
+          if (!res.has_value()) {
+            return;
+          }
+          if (!first) {
+            out += ',';
+          }
+          first = false;
+
+          if (key->type() == ObjectType::OSTRING) {
+            quote(out, object::cast<Object, String>(key)->view());
+          } else {
+            quote(out, key->debug());
+          }
+          out += ':';
+          res = write(out, value, depth + 1);
+        });
+    out += '}';
+    return res;
+  }
+
+  default:
+    return std::unexpected(std::format("cannot convert {} to json",
+                                       OBJECT_TYPE_NAME.at(value->type())));
+  }
+}
+}; // namespace
+
+auto json::stringify(const std::shared_ptr<Object> &value)
+    -> std::expected<string, string> {
+  auto res = string();
+  auto ok = write(res, value, 0);
+  if (!ok.has_value()) {
+    return std::unexpected(ok.error());
+  }
+  return res;
+}
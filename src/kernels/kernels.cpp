@@ -0,0 +1,522 @@
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <kernels.hpp>
+#include <span>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define __ETA_KERNELS_AVX2__ 1
+#endif
+
+using namespace kernels;
+
+namespace {
+// ints wrap around like the vector instructions do
+auto scalar(Op op, int64_t lhs, int64_t rhs) -> int64_t {
+  auto l = static_cast<uint64_t>(lhs);
+  auto r = static_cast<uint64_t>(rhs);
+
+  switch (op) {
+  case Op::ADD:
+    return static_cast<int64_t>(l + r);
+
+  case Op::SUB:
+    return static_cast<int64_t>(l - r);
+
+  case Op::MUL:
+    return static_cast<int64_t>(l * r);
+
+  case Op::DIV:
+    // INT64_MIN / -1 traps, negate instead
+    return rhs == -1 ? static_cast<int64_t>(-l) : lhs / rhs;
+  }
+  return 0;
+}
+
+auto scalar(Op op, double lhs, double rhs) -> double {
+  switch (op) {
+  case Op::ADD:
+    return lhs + rhs;
+
+  case Op::SUB:
+    return lhs - rhs;
+
+  case Op::MUL:
+    return lhs * rhs;
+
+  case Op::DIV:
+    return lhs / rhs;
+  }
+  return 0;
+}
+
+// a step of 0 broadcasts the first element of that side
+template <typename T>
+auto scalar_apply(Op op, const T *lhs, size_t lstep, const T *rhs,
+                  size_t rstep, T *out, size_t from, size_t n) -> void {
+  for (size_t i = from; i < n; i++) {
+    out[i] = scalar(op, lhs[i * lstep], rhs[i * rstep]);
+  }
+}
+
+#if __ETA_KERNELS_AVX2__
+auto avx2() -> bool {
+  static const bool res = [] {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+  }();
+  return res;
+}
+
+[[gnu::target("avx2")]]
+auto avx2_apply(Op op, const double *lhs, size_t lstep, const double *rhs,
+                size_t rstep, double *out, size_t n) -> void {
+  auto lb = _mm256_set1_pd(*lhs);
+  auto rb = _mm256_set1_pd(*rhs);
+
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    auto l = lstep ? _mm256_loadu_pd(lhs + i) : lb;
+    auto r = rstep ? _mm256_loadu_pd(rhs + i) : rb;
+    auto res = _mm256_setzero_pd();
+    switch (op) {
+    case Op::ADD:
+      res = _mm256_add_pd(l, r);
+      break;
+
+    case Op::SUB:
+      res = _mm256_sub_pd(l, r);
+      break;
+
+    case Op::MUL:
+      res = _mm256_mul_pd(l, r);
+      break;
+
+    case Op::DIV:
+      res = _mm256_div_pd(l, r);
+      break;
+    }
+    _mm256_storeu_pd(out + i, res);
+  }
+
+  scalar_apply(op, lhs, lstep, rhs, rstep, out, i, n);
+}
+
+// avx2 has no 64-bit multiply or divide, those stay scalar
+[[gnu::target("avx2")]]
+auto avx2_apply(Op op, const int64_t *lhs, size_t lstep, const int64_t *rhs,
+                size_t rstep, int64_t *out, size_t n) -> void {
+  size_t i = 0;
+  if (op == Op::ADD || op == Op::SUB) {
+    auto lb = _mm256_set1_epi64x(*lhs);
+    auto rb = _mm256_set1_epi64x(*rhs);
+
+    for (; i + 4 <= n; i += 4) {
+      auto l = lstep ? _mm256_loadu_si256(
+                           reinterpret_cast<const __m256i *>(lhs + i))
+                     : lb;
+      auto r = rstep ? _mm256_loadu_si256(
+                           reinterpret_cast<const __m256i *>(rhs + i))
+                     : rb;
+      auto res = op == Op::ADD ? _mm256_add_epi64(l, r)
+                               : _mm256_sub_epi64(l, r);
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), res);
+    }
+  }
+
+  scalar_apply(op, lhs, lstep, rhs, rstep, out, i, n);
+}
+
+[[gnu::target("avx2")]]
+auto avx2_sum(const double *values, size_t n) -> double {
+  auto acc = _mm256_setzero_pd();
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    acc = _mm256_add_pd(acc, _mm256_loadu_pd(values + i));
+  }
+
+  double lanes[4];
+  _mm256_storeu_pd(lanes, acc);
+  auto res = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+  for (; i < n; i++) {
+    res += values[i];
+  }
+  return res;
+}
+
+[[gnu::target("avx2")]]
+auto avx2_sum(const int64_t *values, size_t n) -> int64_t {
+  auto acc = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    acc = _mm256_add_epi64(
+        acc, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i)));
+  }
+
+  int64_t lanes[4];
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes), acc);
+  auto res = scalar(Op::ADD, scalar(Op::ADD, lanes[0], lanes[1]),
+                    scalar(Op::ADD, lanes[2], lanes[3]));
+  for (; i < n; i++) {
+    res = scalar(Op::ADD, res, values[i]);
+  }
+  return res;
+}
+
+[[gnu::target("avx2")]]
+auto avx2_bound(const double *values, size_t n, bool less) -> double {
+  auto acc = _mm256_set1_pd(values[0]);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    auto v = _mm256_loadu_pd(values + i);
+    acc = less ? _mm256_min_pd(acc, v) : _mm256_max_pd(acc, v);
+  }
+
+  double lanes[4];
+  _mm256_storeu_pd(lanes, acc);
+  auto res = lanes[0];
+  for (auto lane : lanes) {
+    res = less ? std::min(res, lane) : std::max(res, lane);
+  }
+  for (; i < n; i++) {
+    res = less ? std::min(res, values[i]) : std::max(res, values[i]);
+  }
+  return res;
+}
+
+[[gnu::target("avx2")]]
+auto avx2_bound(const int64_t *values, size_t n, bool less) -> int64_t {
+  auto acc = _mm256_set1_epi64x(values[0]);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i));
+    auto replace =
+        less ? _mm256_cmpgt_epi64(acc, v) : _mm256_cmpgt_epi64(v, acc);
+    acc = _mm256_blendv_epi8(acc, v, replace);
+  }
+
+  int64_t lanes[4];
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes), acc);
+  auto res = lanes[0];
+  for (auto lane : lanes) {
+    res = less ? std::min(res, lane) : std::max(res, lane);
+  }
+  for (; i < n; i++) {
+    res = less ? std::min(res, values[i]) : std::max(res, values[i]);
+  }
+  return res;
+}
+
+[[gnu::target("avx2")]]
+auto avx2_dot(const double *lhs, const double *rhs, size_t n) -> double {
+  auto acc = _mm256_setzero_pd();
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    acc = _mm256_add_pd(
+        acc, _mm256_mul_pd(_mm256_loadu_pd(lhs + i), _mm256_loadu_pd(rhs + i)));
+  }
+
+  double lanes[4];
+  _mm256_storeu_pd(lanes, acc);
+  auto res = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+  for (; i < n; i++) {
+    res += lhs[i] * rhs[i];
+  }
+  return res;
+}
+
+[[gnu::target("avx2")]]
+auto avx2_bits(BitOp op, const uint64_t *lhs, const uint64_t *rhs,
+               uint64_t *out, size_t n) -> size_t {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    auto l = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lhs + i));
+    auto r = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rhs + i));
+    auto res = _mm256_setzero_si256();
+    switch (op) {
+    case BitOp::AND:
+      res = _mm256_and_si256(l, r);
+      break;
+
+    case BitOp::OR:
+      res = _mm256_or_si256(l, r);
+      break;
+
+    case BitOp::XOR:
+      res = _mm256_xor_si256(l, r);
+      break;
+
+    case BitOp::ANDNOT:
+      // the intrinsic negates its first operand
+      res = _mm256_andnot_si256(r, l);
+      break;
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), res);
+  }
+  return i;
+}
+
+auto popcnt() -> bool {
+  static const bool res = [] {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("popcnt") != 0;
+  }();
+  return res;
+}
+
+auto fma() -> bool {
+  static const bool res = [] {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0 &&
+           __builtin_cpu_supports("fma") != 0;
+  }();
+  return res;
+}
+
+// out[j] += a * row[j], the innermost step of matmul
+[[gnu::target("avx2,fma")]]
+auto fma_axpy(double a, const double *row, double *out, size_t n) -> void {
+  auto va = _mm256_set1_pd(a);
+  size_t j = 0;
+  for (; j + 8 <= n; j += 8) {
+    auto o0 = _mm256_loadu_pd(out + j);
+    auto o1 = _mm256_loadu_pd(out + j + 4);
+    o0 = _mm256_fmadd_pd(va, _mm256_loadu_pd(row + j), o0);
+    o1 = _mm256_fmadd_pd(va, _mm256_loadu_pd(row + j + 4), o1);
+    _mm256_storeu_pd(out + j, o0);
+    _mm256_storeu_pd(out + j + 4, o1);
+  }
+  for (; j < n; j++) {
+    out[j] += a * row[j];
+  }
+}
+
+[[gnu::target("popcnt")]]
+auto popcnt_count(const uint64_t *words, size_t n) -> uint64_t {
+  uint64_t res = 0;
+  for (size_t i = 0; i < n; i++) {
+    res += static_cast<uint64_t>(__builtin_popcountll(words[i]));
+  }
+  return res;
+}
+#endif
+
+auto axpy(double a, const double *row, double *out, size_t n) -> void {
+  for (size_t j = 0; j < n; j++) {
+    out[j] += a * row[j];
+  }
+}
+
+template <typename T>
+auto dispatch_apply(Op op, std::span<const T> lhs, std::span<const T> rhs,
+                    std::span<T> out) -> void {
+  if (out.empty()) {
+    return;
+  }
+
+  size_t lstep = lhs.size() == 1 && rhs.size() != 1 ? 0 : 1;
+  size_t rstep = rhs.size() == 1 && lhs.size() != 1 ? 0 : 1;
+
+#if __ETA_KERNELS_AVX2__
+  if (avx2()) {
+    avx2_apply(op, lhs.data(), lstep, rhs.data(), rstep, out.data(),
+               out.size());
+    return;
+  }
+#endif
+
+  scalar_apply(op, lhs.data(), lstep, rhs.data(), rstep, out.data(), 0,
+               out.size());
+}
+
+template <typename T>
+auto dispatch_bound(std::span<const T> values, bool less) -> T {
+#if __ETA_KERNELS_AVX2__
+  if (avx2()) {
+    return avx2_bound(values.data(), values.size(), less);
+  }
+#endif
+
+  return less ? std::ranges::min(values) : std::ranges::max(values);
+}
+}; // namespace
+
+auto kernels::apply(Op op, std::span<const int64_t> lhs,
+                    std::span<const int64_t> rhs, std::span<int64_t> out)
+    -> void {
+  dispatch_apply(op, lhs, rhs, out);
+}
+
+auto kernels::apply(Op op, std::span<const double> lhs,
+                    std::span<const double> rhs, std::span<double> out)
+    -> void {
+  dispatch_apply(op, lhs, rhs, out);
+}
+
+auto kernels::sum(std::span<const int64_t> values) -> int64_t {
+#if __ETA_KERNELS_AVX2__
+  if (avx2()) {
+    return avx2_sum(values.data(), values.size());
+  }
+#endif
+
+  int64_t res = 0;
+  for (auto v : values) {
+    res = scalar(Op::ADD, res, v);
+  }
+  return res;
+}
+
+auto kernels::sum(std::span<const double> values) -> double {
+#if __ETA_KERNELS_AVX2__
+  if (avx2()) {
+    return avx2_sum(values.data(), values.size());
+  }
+#endif
+
+  double res = 0;
+  for (auto v : values) {
+    res += v;
+  }
+  return res;
+}
+
+auto kernels::min(std::span<const int64_t> values) -> int64_t {
+  return dispatch_bound(values, true);
+}
+
+auto kernels::min(std::span<const double> values) -> double {
+  return dispatch_bound(values, true);
+}
+
+auto kernels::max(std::span<const int64_t> values) -> int64_t {
+  return dispatch_bound(values, false);
+}
+
+auto kernels::max(std::span<const double> values) -> double {
+  return dispatch_bound(values, false);
+}
+
+auto kernels::dot(std::span<const int64_t> lhs, std::span<const int64_t> rhs)
+    -> int64_t {
+  int64_t res = 0;
+  for (size_t i = 0; i < lhs.size(); i++) {
+    res = scalar(Op::ADD, res, scalar(Op::MUL, lhs[i], rhs[i]));
+  }
+  return res;
+}
+
+auto kernels::dot(std::span<const double> lhs, std::span<const double> rhs)
+    -> double {
+#if __ETA_KERNELS_AVX2__
+  if (avx2()) {
+    return avx2_dot(lhs.data(), rhs.data(), lhs.size());
+  }
+#endif
+
+  double res = 0;
+  for (size_t i = 0; i < lhs.size(); i++) {
+    res += lhs[i] * rhs[i];
+  }
+  return res;
+}
+
+auto kernels::bits(BitOp op, std::span<const uint64_t> lhs,
+                   std::span<const uint64_t> rhs, std::span<uint64_t> out)
+    -> void {
+  size_t i = 0;
+#if __ETA_KERNELS_AVX2__
+  if (avx2()) {
+    i = avx2_bits(op, lhs.data(), rhs.data(), out.data(), out.size());
+  }
+#endif
+
+  for (; i < out.size(); i++) {
+    switch (op) {
+    case BitOp::AND:
+      out[i] = lhs[i] & rhs[i];
+      break;
+
+    case BitOp::OR:
+      out[i] = lhs[i] | rhs[i];
+      break;
+
+    case BitOp::XOR:
+      out[i] = lhs[i] ^ rhs[i];
+      break;
+
+    case BitOp::ANDNOT:
+      out[i] = lhs[i] & ~rhs[i];
+      break;
+    }
+  }
+}
+
+auto kernels::popcount(std::span<const uint64_t> words) -> uint64_t {
+#if __ETA_KERNELS_AVX2__
+  if (popcnt()) {
+    return popcnt_count(words.data(), words.size());
+  }
+#endif
+
+  uint64_t res = 0;
+  for (auto w : words) {
+    res += std::popcount(w);
+  }
+  return res;
+}
+
+// i-k-j order walks rows of rhs and out sequentially. a block of
+// BLOCK_K x BLOCK_J doubles of rhs (256kb) stays in L2 while
+// BLOCK_I rows of lhs stream over it
+auto kernels::matmul(std::span<const double> lhs, std::span<const double> rhs,
+                     std::span<double> out, size_t m, size_t k, size_t n)
+    -> void {
+  static const size_t BLOCK_I = 64;
+  static const size_t BLOCK_K = 128;
+  static const size_t BLOCK_J = 256;
+
+  auto step = axpy;
+#if __ETA_KERNELS_AVX2__
+  if (fma()) {
+    step = fma_axpy;
+  }
+#endif
+
+  std::ranges::fill(out, 0.0);
+  for (size_t i0 = 0; i0 < m; i0 += BLOCK_I) {
+    auto i1 = std::min(i0 + BLOCK_I, m);
+    for (size_t p0 = 0; p0 < k; p0 += BLOCK_K) {
+      auto p1 = std::min(p0 + BLOCK_K, k);
+      for (size_t j0 = 0; j0 < n; j0 += BLOCK_J) {
+        auto width = std::min(j0 + BLOCK_J, n) - j0;
+        for (size_t i = i0; i < i1; i++) {
+          for (size_t p = p0; p < p1; p++) {
+            step(lhs[i * k + p], rhs.data() + p * n + j0,
+                 out.data() + i * n + j0, width);
+          }
+        }
+      }
+    }
+  }
+}
+
+// tiles keep both the rows read and the columns written in cache
+auto kernels::transpose(std::span<const double> values, std::span<double> out,
+                        size_t rows, size_t cols) -> void {
+  static const size_t TILE = 32;
+
+  for (size_t i0 = 0; i0 < rows; i0 += TILE) {
+    auto i1 = std::min(i0 + TILE, rows);
+    for (size_t j0 = 0; j0 < cols; j0 += TILE) {
+      auto j1 = std::min(j0 + TILE, cols);
+      for (size_t i = i0; i < i1; i++) {
+        for (size_t j = j0; j < j1; j++) {
+          out[j * rows + i] = values[i * cols + j];
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,100 @@
+#ifndef __ETA_KERNELS_HPP__
+#define __ETA_KERNELS_HPP__
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string_view>
+
+// native loops over packed numeric data. on x86-64 the AVX2 versions
+// are picked at runtime when the cpu has them, everything else runs
+// the scalar loops
+namespace kernels {
+enum class Op : uint8_t { ADD, SUB, MUL, DIV };
+
+// out[i] = lhs[i] op rhs[i], a side with a single element is
+// broadcast against the other one, out has the length of the longer
+auto apply(Op op, std::span<const int64_t> lhs, std::span<const int64_t> rhs,
+           std::span<int64_t> out) -> void;
+auto apply(Op op, std::span<const double> lhs, std::span<const double> rhs,
+           std::span<double> out) -> void;
+
+auto sum(std::span<const int64_t> values) -> int64_t;
+auto sum(std::span<const double> values) -> double;
+
+// values must not be empty
+auto min(std::span<const int64_t> values) -> int64_t;
+auto min(std::span<const double> values) -> double;
+auto max(std::span<const int64_t> values) -> int64_t;
+auto max(std::span<const double> values) -> double;
+
+// lhs and rhs have the same length
+auto dot(std::span<const int64_t> lhs, std::span<const int64_t> rhs)
+    -> int64_t;
+auto dot(std::span<const double> lhs, std::span<const double> rhs) -> double;
+
+enum class BitOp : uint8_t { AND, OR, XOR, ANDNOT };
+
+// word-wise out[i] = lhs[i] op rhs[i] over bit words of the same
+// length, ANDNOT keeps the bits of lhs that are not in rhs
+auto bits(BitOp op, std::span<const uint64_t> lhs,
+          std::span<const uint64_t> rhs, std::span<uint64_t> out) -> void;
+
+// number of set bits, popcnt when the cpu has it
+auto popcount(std::span<const uint64_t> words) -> uint64_t;
+
+// row-major out (m x n) = lhs (m x k) * rhs (k x n), computed in
+// blocks that keep a panel of rhs in cache
+auto matmul(std::span<const double> lhs, std::span<const double> rhs,
+            std::span<double> out, size_t m, size_t k, size_t n) -> void;
+
+// row-major out (cols x rows) = values (rows x cols) transposed
+auto transpose(std::span<const double> values, std::span<double> out,
+               size_t rows, size_t cols) -> void;
+
+// ascending in place. ints and floats are radix sorted, large inputs
+// are split across threads and merged. floats are ordered by their
+// bits: -nan < -inf < ... < -0.0 < 0.0 < ... < inf < nan
+auto sort(std::span<int64_t> values) -> void;
+auto sort(std::span<double> values) -> void;
+
+// substring search for one needle over any number of haystacks. one
+// byte needles are a memchr, short ones a memchr for the first byte
+// and a memcmp for the rest, long ones use boyer-moore-horspool whose
+// skip table is built once here. the needle must outlive the finder
+class Finder {
+public:
+  static constexpr size_t NPOS = std::string_view::npos;
+
+  Finder(std::string_view needle);
+  // first match at or after from, NPOS when there is none
+  auto find(std::string_view haystack, size_t from = 0) const -> size_t;
+
+private:
+  std::string_view needle;
+  std::optional<std::boyer_moore_horspool_searcher<const char *>> horspool;
+};
+
+// first occurrence of any byte of a small set, up to 8 bytes. the
+// AVX2 version compares 32 bytes of text against every byte of the
+// set at once
+class Scanner {
+public:
+  static constexpr size_t NPOS = std::string_view::npos;
+  static constexpr size_t MAX_SET = 8;
+
+  Scanner(std::string_view set);
+  // first byte of the set at or after from, NPOS when there is none
+  auto find(std::string_view text, size_t from = 0) const -> size_t;
+
+private:
+  std::array<char, MAX_SET> set;
+  size_t count;
+  std::array<bool, 256> table;
+};
+}; // namespace kernels
+
+#endif
@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <kernels.hpp>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace kernels;
+
+namespace {
+// below this std::sort beats the counting passes
+const size_t RADIX_MIN = 256;
+// below this the threads cost more than they save
+const size_t PARALLEL_MIN = 1 << 18;
+
+// unsigned keys ordered like the values, the sign bit is flipped for
+// ints, negative floats are inverted whole so they count downwards
+auto key(int64_t value) -> uint64_t {
+  return static_cast<uint64_t>(value) ^ (uint64_t{1} << 63);
+}
+
+auto key(double value) -> uint64_t {
+  auto bits = std::bit_cast<uint64_t>(value);
+  return (bits >> 63) ? ~bits : bits | (uint64_t{1} << 63);
+}
+
+template <typename T> auto before(T lhs, T rhs) -> bool {
+  return key(lhs) < key(rhs);
+}
+
+// lsd radix sort a byte at a time, passes where every key has the
+// same byte are skipped
+template <typename T>
+auto radix(std::span<T> values, std::span<T> buffer) -> void {
+  std::array<std::array<size_t, 256>, 8> counts{};
+  for (auto v : values) {
+    auto k = key(v);
+    for (size_t pass = 0; pass < 8; pass++) {
+      counts[pass][(k >> (pass * 8)) & 0xff]++;
+    }
+  }
+
+  auto from = values;
+  auto to = buffer;
+  for (size_t pass = 0; pass < 8; pass++) {
+    auto &count = counts[pass];
+    if (std::ranges::find(count, values.size()) != count.end()) {
+      continue;
+    }
+
+    size_t offset = 0;
+    for (auto &c : count) {
+      offset += std::exchange(c, offset);
+    }
+
+    for (auto v : from) {
+      to[count[(key(v) >> (pass * 8)) & 0xff]++] = v;
+    }
+    std::swap(from, to);
+  }
+
+  if (from.data() != values.data()) {
+    std::ranges::copy(from, values.begin());
+  }
+}
+
+template <typename T>
+auto sequential(std::span<T> values, std::span<T> buffer) -> void {
+  if (values.size() < RADIX_MIN) {
+    std::ranges::sort(values, before<T>);
+    return;
+  }
+  radix(values, buffer);
+}
+
+// every worker sorts a chunk, then neighbouring runs are merged in
+// rounds until one is left
+template <typename T> auto dispatch_sort(std::span<T> values) -> void {
+  auto buffer = std::vector<T>(values.size());
+  auto workers = std::max<size_t>(1, std::thread::hardware_concurrency());
+  if (values.size() < PARALLEL_MIN || workers == 1) {
+    sequential(values, std::span<T>(buffer));
+    return;
+  }
+
+  auto chunk = (values.size() + workers - 1) / workers;
+  std::vector<size_t> bounds;
+  for (size_t i = 0; i < values.size(); i += chunk) {
+    bounds.push_back(i);
+  }
+  bounds.push_back(values.size());
+
+  std::vector<std::future<void>> jobs;
+  for (size_t i = 0; i + 1 < bounds.size(); i++) {
+    auto size = bounds[i + 1] - bounds[i];
+    jobs.push_back(std::async(std::launch::async, [&, i, size] {
+      sequential(values.subspan(bounds[i], size),
+                 std::span<T>(buffer).subspan(bounds[i], size));
+    }));
+  }
+  for (auto &job : jobs) {
+    job.get();
+  }
+
+  auto from = values;
+  auto to = std::span<T>(buffer);
+  while (bounds.size() > 2) {
+    jobs.clear();
+    std::vector<size_t> next;
+    for (size_t i = 0; i + 1 < bounds.size(); i += 2) {
+      next.push_back(bounds[i]);
+      auto mid = bounds[i + 1];
+      auto end = i + 2 < bounds.size() ? bounds[i + 2] : mid;
+      auto begin = bounds[i];
+      jobs.push_back(std::async(std::launch::async, [=] {
+        std::merge(from.begin() + begin, from.begin() + mid,
+                   from.begin() + mid, from.begin() + end,
+                   to.begin() + begin, before<T>);
+      }));
+    }
+    next.push_back(values.size());
+    for (auto &job : jobs) {
+      job.get();
+    }
+
+    bounds = std::move(next);
+    std::swap(from, to);
+  }
+
+  if (from.data() != values.data()) {
+    std::ranges::copy(from, values.begin());
+  }
+}
+}; // namespace
+
+auto kernels::sort(std::span<int64_t> values) -> void {
+  dispatch_sort(values);
+}
+
+auto kernels::sort(std::span<double> values) -> void {
+  dispatch_sort(values);
+}
@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <kernels.hpp>
+#include <span>
+#include <string_view>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define __ETA_KERNELS_AVX2__ 1
+#endif
+
+using namespace kernels;
+
+// shorter needles are cheaper to verify with memcmp than to build
+// and consult a skip table for
+static const size_t HORSPOOL_MIN = 16;
+
+Finder::Finder(std::string_view needle) : needle(needle) {
+  if (needle.size() >= HORSPOOL_MIN) {
+    horspool.emplace(needle.begin(), needle.end());
+  }
+}
+
+auto Finder::find(std::string_view haystack, size_t from) const -> size_t {
+  if (from > haystack.size() || needle.size() > haystack.size() - from) {
+    return NPOS;
+  }
+
+  if (needle.empty()) {
+    return from;
+  }
+
+  if (horspool) {
+    auto [first, last] = (*horspool)(haystack.begin() + from, haystack.end());
+    return first == haystack.end() ? NPOS : first - haystack.begin();
+  }
+
+  // the last position a match can start at
+  auto *end = haystack.data() + haystack.size() - needle.size() + 1;
+  auto *pos = haystack.data() + from;
+  while (pos < end) {
+    pos = static_cast<const char *>(std::memchr(pos, needle[0], end - pos));
+    if (!pos) {
+      return NPOS;
+    }
+
+    if (std::memcmp(pos + 1, needle.data() + 1, needle.size() - 1) == 0) {
+      return pos - haystack.data();
+    }
+    pos++;
+  }
+  return NPOS;
+}
+
+#if __ETA_KERNELS_AVX2__
+static auto avx2() -> bool {
+  static const bool res = [] {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+  }();
+  return res;
+}
+
+// the first byte of the set within the whole 32 byte blocks, or where
+// the whole blocks end
+[[gnu::target("avx2")]]
+static auto avx2_scan(std::span<const char> set, const char *data,
+                      size_t from, size_t n) -> size_t {
+  __m256i needles[Scanner::MAX_SET];
+  for (size_t j = 0; j < set.size(); j++) {
+    needles[j] = _mm256_set1_epi8(set[j]);
+  }
+
+  auto i = from;
+  for (; i + 32 <= n; i += 32) {
+    auto block =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+    auto hits = _mm256_cmpeq_epi8(block, needles[0]);
+    for (size_t j = 1; j < set.size(); j++) {
+      hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(block, needles[j]));
+    }
+    auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(hits));
+    if (mask != 0) {
+      return i + std::countr_zero(mask);
+    }
+  }
+  return i;
+}
+#endif
+
+Scanner::Scanner(std::string_view set)
+    : count(std::min(set.size(), MAX_SET)) {
+  table.fill(false);
+  for (size_t i = 0; i < count; i++) {
+    this->set[i] = set[i];
+    table[static_cast<uint8_t>(set[i])] = true;
+  }
+}
+
+auto Scanner::find(std::string_view text, size_t from) const -> size_t {
+  if (count == 0) {
+    return NPOS;
+  }
+
+  auto i = from;
+#if __ETA_KERNELS_AVX2__
+  if (avx2()) {
+    i = avx2_scan(std::span(set.data(), count), text.data(), from,
+                  text.size());
+  }
+#endif
+
+  for (; i < text.size(); i++) {
+    if (table[static_cast<uint8_t>(text[i])]) {
+      return i;
+    }
+  }
+  return NPOS;
+}
@@ -1,4 +1,5 @@
 #include <any>
+#include <atomic>
 #include <cctype>
 #include <cmath>
 #include <cstdint>
@@ -20,6 +21,7 @@ static const map<string_view, token::Token> KEYWORDS = {
     {"if", token::Token::TIF},
     {"else", token::Token::TELSE},
     {"for", token::Token::TFOR},
+    {"in", token::Token::TIN},
     {"break", token::Token::TBREAK},
     {"continue", token::Token::TCONTINUE},
     {"return", token::Token::TRETURN},
@@ -28,6 +30,7 @@ static const map<string_view, token::Token> KEYWORDS = {
     {"true", token::Token::TBOOL},
     {"false", token::Token::TBOOL},
     {"struct", token::Token::TSTRUCT},
+    {"import", token::Token::TIMPORT},
 };
 
 static const map<char16_t, token::Token> SPECIAL_CHARS = {
@@ -45,12 +48,19 @@ static const map<char16_t, token::Token> SPECIAL_CHARS = {
     {'!', token::Token::TNOT},
 };
 
+// modules are lexed on several threads
+static std::atomic<uint32_t> sources = types::Position::RUNNING + 1;
+
 Lexer::Lexer(const string &filename, const string &data)
-    : filename(filename), data(data) {}
+    : filename(filename), data(data), source(sources++) {
+  position.source = source;
+  last_position.source = source;
+}
 
 auto Lexer::set_position(this Lexer &self, const types::Position &pos) -> void {
   self.last_position = pos;
-  self.position = pos;
+  self.last_position.source = self.source;
+  self.position = self.last_position;
 }
 
 auto Lexer::is_end(this const Lexer &self) -> bool {
@@ -286,6 +296,10 @@ auto Lexer::get_token(this Lexer &self) -> token::Token {
 auto Lexer::get_value(this const Lexer &self) -> std::any { return self.value; }
 
 auto Lexer::get_line(this const Lexer &self) -> string {
+  if (self.last_position.linebeg > self.data.length()) {
+    return {};
+  }
+
   auto end_index = self.data.find_first_of('\n', self.last_position.linebeg);
   if (end_index == std::string::npos) {
     return self.data.substr(self.last_position.linebeg);
@@ -311,3 +325,7 @@ auto Lexer::get_last_position(this const Lexer &self) -> types::Position {
 auto Lexer::get_filename(this const Lexer &self) -> const string & {
   return self.filename;
 }
+
+auto Lexer::get_source(this const Lexer &self) -> uint32_t {
+  return self.source;
+}
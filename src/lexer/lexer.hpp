@@ -2,6 +2,7 @@
 #define __ETA_LEXER_HPP__
 
 #include <any>
+#include <cstdint>
 #include <debug.hpp>
 #include <string>
 #include <token.hpp>
@@ -23,6 +24,7 @@ public:
   auto get_position(this const Lexer &self) -> types::Position;
   auto get_last_position(this const Lexer &self) -> types::Position;
   auto get_filename(this const Lexer &self) -> const string &;
+  auto get_source(this const Lexer &self) -> uint32_t;
 
 private:
   auto is_end(this const Lexer &self) -> bool;
@@ -39,6 +41,8 @@ private:
   token::Token last_token;
   types::Position position;
   types::Position last_position;
+  // tags every position, unique among the lexers of a run
+  uint32_t source;
   any value;
 };
 }; // namespace lexer
@@ -0,0 +1,64 @@
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <object.hpp>
+#include <span>
+#include <utility>
+#include <vector>
+
+using namespace object;
+
+Bitset::Bitset(size_t bits) : data((bits + 63) / 64), bits(bits) {}
+
+Bitset::Bitset(size_t bits, std::vector<uint64_t> words)
+    : data(std::move(words)), bits(bits) {
+  data.resize((bits + 63) / 64);
+  if (bits % 64 != 0) {
+    data.back() &= (uint64_t{1} << (bits % 64)) - 1;
+  }
+}
+
+auto Bitset::size() const -> size_t { return bits; }
+
+auto Bitset::test(size_t i) const -> bool {
+  return (data[i / 64] >> (i % 64)) & 1;
+}
+
+auto Bitset::set(size_t i, bool value) -> void {
+  auto mask = uint64_t{1} << (i % 64);
+  if (value) {
+    data[i / 64] |= mask;
+  } else {
+    data[i / 64] &= ~mask;
+  }
+}
+
+// skips whole zero words, the first set bit of a word is its count
+// of trailing zeros
+auto Bitset::next(size_t from) const -> size_t {
+  if (from >= bits) {
+    return bits;
+  }
+
+  auto w = from / 64;
+  auto word = data[w] & (~uint64_t{0} << (from % 64));
+  while (word == 0) {
+    if (++w == data.size()) {
+      return bits;
+    }
+    word = data[w];
+  }
+  return w * 64 + std::countr_zero(word);
+}
+
+auto Bitset::words() const -> std::span<const uint64_t> { return data; }
+
+auto Bitset::type() const -> ObjectType { return ObjectType::OBITSET; }
+auto Bitset::debug() const -> string {
+  string res = "bitset(";
+  for (size_t i = 0; i < bits; i++) {
+    res += test(i) ? '1' : '0';
+  }
+  res += ')';
+  return res;
+}
@@ -0,0 +1,77 @@
+#include <cstddef>
+#include <memory>
+#include <object.hpp>
+#include <utility>
+#include <vector>
+
+using namespace object;
+
+Deque::Deque() : ring(8) {}
+
+auto Deque::size() const -> size_t { return length; }
+
+auto Deque::at(size_t i) const -> const std::shared_ptr<Object> & {
+  return ring[(head + i) & (ring.size() - 1)];
+}
+
+auto Deque::set(size_t i, std::shared_ptr<Object> obj) -> void {
+  ring[(head + i) & (ring.size() - 1)] = std::move(obj);
+}
+
+auto Deque::push_back(std::shared_ptr<Object> obj) -> void {
+  if (length == ring.size()) {
+    grow();
+  }
+  ring[(head + length) & (ring.size() - 1)] = std::move(obj);
+  length++;
+}
+
+auto Deque::push_front(std::shared_ptr<Object> obj) -> void {
+  if (length == ring.size()) {
+    grow();
+  }
+  head = (head - 1) & (ring.size() - 1);
+  ring[head] = std::move(obj);
+  length++;
+}
+
+// slots are cleared so popped objects are released right away
+auto Deque::pop_back() -> void {
+  length--;
+  ring[(head + length) & (ring.size() - 1)].reset();
+}
+
+auto Deque::pop_front() -> void {
+  ring[head].reset();
+  head = (head + 1) & (ring.size() - 1);
+  length--;
+}
+
+// unrolls the ring into a buffer twice the size, head restarts at 0
+auto Deque::grow() -> void {
+  auto res = std::vector<std::shared_ptr<Object>>(ring.size() * 2);
+  for (size_t i = 0; i < length; i++) {
+    res[i] = std::move(ring[(head + i) & (ring.size() - 1)]);
+  }
+  ring = std::move(res);
+  head = 0;
+}
+
+auto Deque::type() const -> ObjectType { return ObjectType::ODEQUE; }
+auto Deque::debug() const -> string {
+  string res = "deque[";
+  for (size_t i = 0; i < length; i++) {
+    auto &e = at(i);
+    if (e->type() == ObjectType::OSTRING) {
+      res += '"' + e->debug() + '"';
+    } else {
+      res += e->debug();
+    }
+
+    if (length - 1 != i) {
+      res += ", ";
+    }
+  }
+  res += ']';
+  return res;
+}
@@ -0,0 +1,244 @@
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <object.hpp>
+#include <optional>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace object;
+
+// control bytes, a full slot stores the low 7 bits of its hash
+static const int8_t EMPTY = -128;
+static const int8_t DELETED = -2;
+static const size_t GROUP = 16;
+
+namespace {
+// spreads int keys over the whole word, identity hashes would put
+// consecutive ints into the same group
+auto mix(uint64_t x) -> uint64_t {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111eb;
+  x ^= x >> 31;
+  return x;
+}
+
+auto hash_of(const Object &key) -> uint64_t {
+  switch (key.type()) {
+  case ObjectType::OINT: {
+    auto value = static_cast<const Integer &>(key).value;
+    return mix(static_cast<uint64_t>(value));
+  }
+
+  case ObjectType::OBOOL:
+    return mix(static_cast<const Bool &>(key).value ? 0x9e3779b97f4a7c15 : 1);
+
+  case ObjectType::OSTRING:
+    return mix(static_cast<const String &>(key).hash());
+
+  default:
+    return 0;
+  }
+}
+
+auto equal(const Object &lhs, const Object &rhs) -> bool {
+  if (&lhs == &rhs) {
+    return true;
+  }
+
+  if (lhs.type() != rhs.type()) {
+    return false;
+  }
+
+  switch (lhs.type()) {
+  case ObjectType::OINT:
+    return static_cast<const Integer &>(lhs).value ==
+           static_cast<const Integer &>(rhs).value;
+
+  case ObjectType::OBOOL:
+    return static_cast<const Bool &>(lhs).value ==
+           static_cast<const Bool &>(rhs).value;
+
+  case ObjectType::OSTRING:
+    return static_cast<const String &>(lhs).view() ==
+           static_cast<const String &>(rhs).view();
+
+  default:
+    return false;
+  }
+}
+
+// bit i is set when control byte i of the group equals value
+auto match(const int8_t *group, int8_t value) -> uint32_t {
+#if defined(__SSE2__)
+  auto ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i *>(group));
+  return static_cast<uint32_t>(
+      _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(value))));
+#else
+  uint32_t res = 0;
+  for (size_t i = 0; i < GROUP; i++) {
+    res |= static_cast<uint32_t>(group[i] == value) << i;
+  }
+  return res;
+#endif
+}
+
+auto h1(uint64_t hash) -> size_t { return hash >> 7; }
+auto h2(uint64_t hash) -> int8_t { return static_cast<int8_t>(hash & 0x7f); }
+}; // namespace
+
+Dict::Dict() { rehash(GROUP); }
+
+auto Dict::hashable(const std::shared_ptr<Object> &key) -> bool {
+  switch (key->type()) {
+  case ObjectType::OINT:
+  case ObjectType::OBOOL:
+  case ObjectType::OSTRING:
+    return true;
+
+  default:
+    return false;
+  }
+}
+
+auto Dict::size() const -> size_t { return live; }
+
+auto Dict::get(const std::shared_ptr<Object> &key) const
+    -> std::shared_ptr<Object> {
+  if (auto i = find(*key, hash_of(*key))) {
+    return entries[slots[*i]].value;
+  }
+  return nullptr;
+}
+
+auto Dict::set(std::shared_ptr<Object> key, std::shared_ptr<Object> value)
+    -> void {
+  auto hash = hash_of(*key);
+  if (auto i = find(*key, hash)) {
+    entries[slots[*i]].value = std::move(value);
+    return;
+  }
+
+  // at most 7/8 of the slots may be taken, removed ones included
+  if ((filled + 1) * 8 > ctrl.size() * 7) {
+    rehash(std::bit_ceil(std::max(GROUP, (live + 1) * 2)));
+  }
+
+  // the caller may mutate its string later, the key gets its own object
+  if (key->type() == ObjectType::OSTRING) {
+    auto str = object::cast<Object, String>(std::move(key));
+    key = str->interned() ? std::move(str) : str->substr(0, str->size());
+  }
+
+  entries.push_back({std::move(key), std::move(value), hash});
+  place(hash, entries.size() - 1);
+  live++;
+}
+
+auto Dict::remove(const std::shared_ptr<Object> &key) -> bool {
+  auto i = find(*key, hash_of(*key));
+  if (!i) {
+    return false;
+  }
+
+  auto &entry = entries[slots[*i]];
+  entry.key = nullptr;
+  entry.value = nullptr;
+  ctrl[*i] = DELETED;
+  live--;
+  return true;
+}
+
+auto Dict::each(const std::function<void(const std::shared_ptr<Object> &,
+                                         const std::shared_ptr<Object> &)> &fn)
+    const -> void {
+  for (const auto &entry : entries) {
+    if (entry.key) {
+      fn(entry.key, entry.value);
+    }
+  }
+}
+
+// groups are probed triangularly, with a power of two group count
+// that visits every group exactly once
+auto Dict::find(const Object &key, uint64_t hash) const
+    -> std::optional<size_t> {
+  auto groups = ctrl.size() / GROUP;
+  auto g = h1(hash) & (groups - 1);
+
+  for (size_t step = 1; step <= groups; step++) {
+    auto base = g * GROUP;
+    for (auto bits = match(&ctrl[base], h2(hash)); bits; bits &= bits - 1) {
+      auto i = base + std::countr_zero(bits);
+      const auto &entry = entries[slots[i]];
+      if (entry.hash == hash && equal(*entry.key, key)) {
+        return i;
+      }
+    }
+
+    if (match(&ctrl[base], EMPTY)) {
+      return std::nullopt;
+    }
+    g = (g + step) & (groups - 1);
+  }
+
+  return std::nullopt;
+}
+
+auto Dict::place(uint64_t hash, uint32_t entry) -> void {
+  auto groups = ctrl.size() / GROUP;
+  auto g = h1(hash) & (groups - 1);
+
+  for (size_t step = 1;; step++) {
+    auto base = g * GROUP;
+    auto bits = match(&ctrl[base], EMPTY) | match(&ctrl[base], DELETED);
+    if (bits) {
+      auto i = base + std::countr_zero(bits);
+      if (ctrl[i] == EMPTY) {
+        filled++;
+      }
+      ctrl[i] = h2(hash);
+      slots[i] = entry;
+      return;
+    }
+    g = (g + step) & (groups - 1);
+  }
+}
+
+// drops removed entries and rebuilds the control bytes
+auto Dict::rehash(size_t capacity) -> void {
+  std::erase_if(entries, [](const Entry &e) { return !e.key; });
+
+  ctrl.assign(capacity, EMPTY);
+  slots.assign(capacity, 0);
+  filled = 0;
+  for (size_t i = 0; i < entries.size(); i++) {
+    place(entries[i].hash, i);
+  }
+}
+
+auto Dict::type() const -> ObjectType { return ObjectType::ODICT; }
+auto Dict::debug() const -> string {
+  auto quote = [](const std::shared_ptr<Object> &obj) {
+    return obj->type() == ObjectType::OSTRING ? '"' + obj->debug() + '"'
+                                              : obj->debug();
+  };
+
+  string res = "{";
+  auto first = true;
+  each([&](const auto &key, const auto &value) {
+    if (!first) {
+      res += ", ";
+    }
+    first = false;
+    res += quote(key) + ": " + quote(value);
+  });
+  res += '}';
+
+  return res;
+}
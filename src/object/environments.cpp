@@ -7,31 +7,73 @@ Environment::Environment() { this->outer = nullptr; }
 Environment::Environment(std::shared_ptr<Environment> outer) {
   this->outer = outer;
 }
-auto Environment::exists(string name) -> bool { return data.contains(name); }
 
-auto Environment::get(string name) -> std::optional<std::shared_ptr<Object>> {
-  if (data.contains(name)) {
-    return data.at(name);
-  }
+auto Environment::exists(const string &name) -> bool {
+  auto it = data.find(name);
+  return it != data.end() && it->second->bound;
+}
 
-  if (outer == nullptr) {
-    return {};
+auto Environment::get(const string &name)
+    -> std::optional<std::shared_ptr<Object>> {
+  for (auto env = this; env != nullptr; env = env->outer.get()) {
+    if (auto it = env->data.find(name);
+        it != env->data.end() && it->second->bound) {
+      return it->second->value;
+    }
   }
 
-  return outer->get(name);
+  return {};
 }
 
-auto Environment::set(string name, std::shared_ptr<Object> obj)
+auto Environment::set(const string &name, std::shared_ptr<Object> obj)
     -> std::shared_ptr<Object> {
-  data[name] = obj;
+  auto &entry = data[name];
+  if (!entry) {
+    entry = std::make_shared<Slot>();
+  }
+
+  entry->value = obj;
+  entry->bound = true;
   return obj;
 }
 
-auto Environment::update(string name, std::shared_ptr<Object> obj)
+auto Environment::update(const string &name, std::shared_ptr<Object> obj)
     -> std::shared_ptr<Object> {
-  if (exists(name)) {
-    return set(name, obj);
+  for (auto env = this; env != nullptr; env = env->outer.get()) {
+    if (auto it = env->data.find(name);
+        it != env->data.end() && it->second->bound) {
+      it->second->value = obj;
+      return obj;
+    }
+  }
+
+  return obj;
+}
+
+auto Environment::reserve(const string &name) -> void {
+  if (!data.contains(name)) {
+    data[name] = std::make_shared<Slot>();
   }
+}
+
+auto Environment::slot(const string &name) -> std::shared_ptr<Slot> {
+  for (auto env = this; env != nullptr; env = env->outer.get()) {
+    if (auto it = env->data.find(name); it != env->data.end()) {
+      return it->second;
+    }
+  }
+
+  return nullptr;
+}
+
+auto Environment::bind(const string &name, std::shared_ptr<Slot> slot)
+    -> void {
+  data[name] = std::move(slot);
+}
+
+auto Environment::parent() -> std::shared_ptr<Environment> { return outer; }
 
-  return outer->update(name, obj);
+auto Environment::entries()
+    -> const std::map<string, std::shared_ptr<Slot>> & {
+  return data;
 }
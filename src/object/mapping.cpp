@@ -0,0 +1,58 @@
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <fcntl.h>
+#include <format>
+#include <memory>
+#include <object.hpp>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace object;
+
+Mapping::Mapping(void *data, size_t count, Kind kind, bool writable)
+    : data(data), count(count), kind(kind), writable(writable) {}
+
+Mapping::~Mapping() {
+  if (data != nullptr) {
+    munmap(data, count * sizeof(int64_t));
+  }
+}
+
+// the mapping outlives the descriptor. the kernel is told the file is
+// read front to back so it reads ahead and drops pages behind
+auto Mapping::open(const string &path, Kind kind, bool writable)
+    -> std::expected<std::shared_ptr<Mapping>, string> {
+  auto fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return std::unexpected(std::format("cannot open file: {}", path));
+  }
+
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    close(fd);
+    return std::unexpected(std::format("cannot open file: {}", path));
+  }
+  auto bytes = static_cast<size_t>(info.st_size);
+  if (bytes % sizeof(int64_t) != 0) {
+    close(fd);
+    return std::unexpected(
+        std::format("size of {} is not a multiple of 8 bytes", path));
+  }
+
+  void *data = nullptr;
+  if (bytes != 0) {
+    auto prot = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+    data = mmap(nullptr, bytes, prot, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      close(fd);
+      return std::unexpected(std::format("cannot map file: {}", path));
+    }
+    madvise(data, bytes, MADV_SEQUENTIAL);
+  }
+  close(fd);
+
+  return std::make_shared<Mapping>(data, bytes / sizeof(int64_t), kind,
+                                   writable);
+}
@@ -0,0 +1,48 @@
+#include <cstddef>
+#include <format>
+#include <object.hpp>
+#include <span>
+#include <utility>
+#include <vector>
+
+using namespace object;
+
+Matrix::Matrix(size_t rows, size_t cols)
+    : height(rows), width(cols), data(rows * cols) {}
+
+Matrix::Matrix(size_t rows, size_t cols, std::vector<double> values)
+    : height(rows), width(cols), data(std::move(values)) {}
+
+auto Matrix::rows() const -> size_t { return height; }
+auto Matrix::cols() const -> size_t { return width; }
+
+auto Matrix::at(size_t i, size_t j) const -> double {
+  return data[i * width + j];
+}
+
+auto Matrix::set(size_t i, size_t j, double value) -> void {
+  data[i * width + j] = value;
+}
+
+auto Matrix::values() const -> std::span<const double> { return data; }
+
+auto Matrix::type() const -> ObjectType { return ObjectType::OMATRIX; }
+auto Matrix::debug() const -> string {
+  string res = "matrix[";
+  for (size_t i = 0; i < height; i++) {
+    res += '[';
+    for (size_t j = 0; j < width; j++) {
+      res += std::format("{}", at(i, j));
+      if (width - 1 != j) {
+        res += ", ";
+      }
+    }
+    res += ']';
+
+    if (height - 1 != i) {
+      res += ", ";
+    }
+  }
+  res += ']';
+  return res;
+}
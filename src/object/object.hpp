@@ -4,15 +4,25 @@
 #include <ast.hpp>
 #include <cmath>
 #include <cstdint>
+#include <expected>
 #include <functional>
 #include <list>
 #include <map>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <variant>
 #include <vector>
 
 using std::string;
+using std::string_view;
+
+namespace regex {
+class Regex;
+};
 
 namespace object {
 enum ObjectType : uint8_t {
@@ -27,6 +37,14 @@ enum ObjectType : uint8_t {
   ODETAILEDERROR,
   OFUNCTION,
   OBUILTINFUNCTION,
+  ODICT,
+  OMAP,
+  OPQUEUE,
+  ODEQUE,
+  OBITSET,
+  OMATRIX,
+  OREGEX,
+  ORANGE,
 };
 
 const std::map<ObjectType, const string> OBJECT_TYPE_NAME = {
@@ -34,6 +52,10 @@ const std::map<ObjectType, const string> OBJECT_TYPE_NAME = {
     {OFLOAT, "float"},       {OBOOL, "bool"},
     {OSTRING, "string"},     {OARRAY, "array"},
     {OFUNCTION, "function"}, {OBUILTINFUNCTION, "builtin function"},
+    {ODICT, "dict"},         {OMAP, "map"},
+    {OPQUEUE, "pq"},         {ODEQUE, "deque"},
+    {OBITSET, "bitset"},     {OMATRIX, "matrix"},
+    {OREGEX, "regex"},       {ORANGE, "range"},
 };
 
 struct Object {
@@ -47,19 +69,33 @@ std::shared_ptr<Y> cast(std::shared_ptr<X> old) {
   return std::shared_ptr<Y>(std::dynamic_pointer_cast<Y>(std::move(old)));
 }
 
+// a variable binding, closures hold on to the slot itself so an
+// assignment on either side stays visible to the other. a slot is
+// reserved (unbound) while the value of its let is being evaluated.
+struct Slot {
+  std::shared_ptr<Object> value;
+  bool bound = false;
+};
+
 class Environment {
 public:
   Environment();
   Environment(std::shared_ptr<Environment> outer);
 
-  auto exists(string name) -> bool;
-  auto get(string name) -> std::optional<std::shared_ptr<Object>>;
-  auto set(string name, std::shared_ptr<Object> obj) -> std::shared_ptr<Object>;
-  auto update(string name, std::shared_ptr<Object> obj)
+  auto exists(const string &name) -> bool;
+  auto get(const string &name) -> std::optional<std::shared_ptr<Object>>;
+  auto set(const string &name, std::shared_ptr<Object> obj)
+      -> std::shared_ptr<Object>;
+  auto update(const string &name, std::shared_ptr<Object> obj)
       -> std::shared_ptr<Object>;
+  auto reserve(const string &name) -> void;
+  auto slot(const string &name) -> std::shared_ptr<Slot>;
+  auto bind(const string &name, std::shared_ptr<Slot> slot) -> void;
+  auto parent() -> std::shared_ptr<Environment>;
+  auto entries() -> const std::map<string, std::shared_ptr<Slot>> &;
 
 private:
-  std::map<string, std::shared_ptr<Object>> data;
+  std::map<string, std::shared_ptr<Slot>> data;
   std::shared_ptr<Environment> outer;
 };
 
@@ -98,22 +134,376 @@ struct Bool : Object {
 
 // ---------------------------------------
 // STRING TYPE
+// strings look at a [offset, offset + length) window of a shared
+// buffer. concatenation extends the buffer in place when the left
+// operand ends where the buffer ends, so s = s + piece stays linear;
+// strings sharing the buffer keep reading their own shorter window.
 struct String : Object {
-  string value;
-
   String();
   String(string value);
+  auto view() const -> string_view;
+  auto size() const -> size_t;
+  auto substr(size_t pos, size_t count) const -> std::shared_ptr<String>;
+  auto concat(string_view rhs) const -> std::shared_ptr<String>;
+  auto append(string_view rhs) -> void;
+  auto set(size_t i, char c) -> void;
+  auto interned() const -> bool;
+  auto hash() const -> uint64_t;
   auto type() const -> ObjectType;
   auto debug() const -> string;
+
+private:
+  friend class Strings;
+
+  std::shared_ptr<string> buffer;
+  size_t offset;
+  size_t length;
+  bool constant = false;
+  mutable uint64_t hashed = 0;
+  mutable bool has_hash = false;
+};
+
+// intern table holding one immutable String per distinct content, so
+// two interned strings are equal exactly when they are the same object
+class Strings {
+public:
+  auto intern(string_view value) -> const std::shared_ptr<String> &;
+
+private:
+  struct Hash {
+    using is_transparent = void;
+    auto operator()(string_view value) const -> size_t {
+      return std::hash<string_view>{}(value);
+    }
+  };
+
+  std::unordered_map<string, std::shared_ptr<String>, Hash, std::equal_to<>>
+      table;
+};
+
+// ---------------------------------------
+// MAPPING
+// a file of raw native-endian int64 or float64 values mapped into
+// memory, pages are read in as they are touched. a writable mapping
+// is private, writes to it never reach the file
+struct Mapping {
+  enum class Kind : uint8_t { INTS, FLOATS };
+
+  static auto open(const string &path, Kind kind, bool writable)
+      -> std::expected<std::shared_ptr<Mapping>, string>;
+
+  Mapping(void *data, size_t count, Kind kind, bool writable);
+  Mapping(const Mapping &) = delete;
+  auto operator=(const Mapping &) -> Mapping & = delete;
+  ~Mapping();
+
+  void *data;
+  size_t count;
+  Kind kind;
+  bool writable;
 };
 
 // ---------------------------------------
 // Array TYPE
+// copies and slices share one refcounted storage and only look at
+// their own [offset, offset + length) window of it, the first
+// mutation through a shared or windowed array copies that window.
+// while all elements are ints (or all floats) the storage is a packed
+// vector of scalars boxed again on read, storing any other type
+// converts it back to a vector of objects. an array over a mapping
+// reads the file in place, a write the mapping can't take in place
+// copies the window into packed storage first
 struct Array : Object {
-  std::vector<std::shared_ptr<Object>> elements;
+  using Boxed = std::vector<std::shared_ptr<Object>>;
+  using Ints = std::vector<int64_t>;
+  using Floats = std::vector<double>;
 
+  Array();
+  Array(Boxed elements);
+  Array(Ints elements);
+  Array(Floats elements);
+  Array(std::shared_ptr<Mapping> mapping);
+
+  auto size() const -> size_t;
+  auto at(size_t i) const -> std::shared_ptr<Object>;
+  auto set(size_t i, std::shared_ptr<Object> obj) -> void;
+  auto push(std::shared_ptr<Object> obj) -> void;
+  auto pop() -> void;
+  auto slice(size_t start, size_t end) const -> std::shared_ptr<Array>;
+  auto ints() const -> std::optional<std::span<const int64_t>>;
+  auto floats() const -> std::optional<std::span<const double>>;
   auto type() const -> ObjectType;
   auto debug() const -> string;
+
+private:
+  using Storage = std::variant<Boxed, Ints, Floats>;
+
+  auto own() -> void;
+  auto fit(const std::shared_ptr<Object> &obj) -> void;
+  auto unmap() -> void;
+
+  std::shared_ptr<Storage> storage;
+  std::shared_ptr<Mapping> mapping;
+  size_t offset;
+  size_t length;
+};
+
+// ---------------------------------------
+// DICT TYPE
+// open addressing in the swiss table style: a control byte per slot
+// holds 7 bits of the key's hash, a whole group of 16 is compared at
+// once and only matching slots look at their key. slots point into an
+// insertion ordered entry list, removed entries stay as holes until
+// the next rehash. keys are ints, strings and bools
+struct Dict : Object {
+  Dict();
+
+  static auto hashable(const std::shared_ptr<Object> &key) -> bool;
+
+  auto size() const -> size_t;
+  auto get(const std::shared_ptr<Object> &key) const -> std::shared_ptr<Object>;
+  auto set(std::shared_ptr<Object> key, std::shared_ptr<Object> value)
+      -> void;
+  auto remove(const std::shared_ptr<Object> &key) -> bool;
+  auto each(const std::function<void(const std::shared_ptr<Object> &,
+                                     const std::shared_ptr<Object> &)> &fn)
+      const -> void;
+  auto type() const -> ObjectType;
+  auto debug() const -> string;
+
+private:
+  struct Entry {
+    std::shared_ptr<Object> key;
+    std::shared_ptr<Object> value;
+    uint64_t hash;
+  };
+
+  auto find(const Object &key, uint64_t hash) const -> std::optional<size_t>;
+  auto rehash(size_t capacity) -> void;
+  auto place(uint64_t hash, uint32_t entry) -> void;
+
+  std::vector<int8_t> ctrl;
+  std::vector<uint32_t> slots;
+  std::vector<Entry> entries;
+  size_t live = 0;
+  size_t filled = 0;
+};
+
+// ---------------------------------------
+// ORDERED MAP TYPE
+// keys of a single type (ints, floats or strings) kept sorted in a
+// b-tree. nodes are wide and hold the keys unboxed, a lookup touches
+// a handful of contiguous key arrays instead of chasing pointers
+struct OrderedTree;
+
+struct OrderedMap : Object {
+  using Visitor = std::function<bool(const std::shared_ptr<Object> &,
+                                     const std::shared_ptr<Object> &)>;
+
+  OrderedMap();
+  ~OrderedMap();
+
+  static auto orderable(const std::shared_ptr<Object> &key) -> bool;
+
+  // the first key fixes the key type of the map
+  auto accepts(const std::shared_ptr<Object> &key) const -> bool;
+  auto size() const -> size_t;
+  auto get(const std::shared_ptr<Object> &key) const -> std::shared_ptr<Object>;
+  auto set(std::shared_ptr<Object> key, std::shared_ptr<Object> value)
+      -> void;
+  auto remove(const std::shared_ptr<Object> &key) -> bool;
+
+  // smallest key >= (lower) or > (upper) than key, null when none is
+  auto lower_bound(const std::shared_ptr<Object> &key) const
+      -> std::shared_ptr<Object>;
+  auto upper_bound(const std::shared_ptr<Object> &key) const
+      -> std::shared_ptr<Object>;
+
+  // in order over from <= key < to, a null bound is open. stops early
+  // when fn returns false, the map must not change meanwhile
+  auto each(const std::shared_ptr<Object> &from,
+            const std::shared_ptr<Object> &to, const Visitor &fn) const
+      -> void;
+  auto visiting() const -> bool;
+  auto type() const -> ObjectType;
+  auto debug() const -> string;
+
+private:
+  std::unique_ptr<OrderedTree> tree;
+  mutable size_t visitors = 0;
+};
+
+// ---------------------------------------
+// PRIORITY QUEUE TYPE
+// a binary min-heap. without a comparator elements are ints, floats or
+// strings in their natural order and int-only or float-only heaps are
+// packed scalars sifted without boxing. with one, before(a, b) decides
+// and the queue must not change while it runs
+struct PriorityQueue : Object {
+  using Boxed = std::vector<std::shared_ptr<Object>>;
+  using Ints = std::vector<int64_t>;
+  using Floats = std::vector<double>;
+  using Before = std::function<bool(const std::shared_ptr<Object> &,
+                                    const std::shared_ptr<Object> &)>;
+
+  PriorityQueue();
+  PriorityQueue(std::shared_ptr<Object> comparator);
+
+  static auto orderable(const std::shared_ptr<Object> &obj) -> bool;
+
+  // natural order only mixes ints with floats
+  auto accepts(const std::shared_ptr<Object> &obj) const -> bool;
+  auto comparator() const -> const std::shared_ptr<Object> &;
+  auto size() const -> size_t;
+  // storage order, the first element is the top
+  auto at(size_t i) const -> std::shared_ptr<Object>;
+  auto push(std::shared_ptr<Object> obj) -> void;
+  auto push(std::shared_ptr<Object> obj, const Before &before) -> void;
+  auto pop() -> std::shared_ptr<Object>;
+  auto pop(const Before &before) -> std::shared_ptr<Object>;
+  // rebuilds a queue saved in storage order, false when an element
+  // does not fit the natural order
+  auto restore(std::shared_ptr<Object> comparator, Boxed elements) -> bool;
+  auto ordering() const -> bool;
+  auto type() const -> ObjectType;
+  auto debug() const -> string;
+
+private:
+  auto fit(const std::shared_ptr<Object> &obj) -> void;
+
+  std::shared_ptr<Object> cmp;
+  std::variant<Boxed, Ints, Floats> heap;
+  bool busy = false;
+};
+
+// ---------------------------------------
+// DEQUE TYPE
+// a growable ring buffer, the capacity is a power of two so the
+// physical slot of an index is a mask away from head
+struct Deque : Object {
+  Deque();
+
+  auto size() const -> size_t;
+  auto at(size_t i) const -> const std::shared_ptr<Object> &;
+  auto set(size_t i, std::shared_ptr<Object> obj) -> void;
+  auto push_back(std::shared_ptr<Object> obj) -> void;
+  auto push_front(std::shared_ptr<Object> obj) -> void;
+  auto pop_back() -> void;
+  auto pop_front() -> void;
+  auto type() const -> ObjectType;
+  auto debug() const -> string;
+
+private:
+  auto grow() -> void;
+
+  std::vector<std::shared_ptr<Object>> ring;
+  size_t head = 0;
+  size_t length = 0;
+};
+
+// ---------------------------------------
+// BITSET TYPE
+// a fixed number of bits packed into 64-bit words, the bits past the
+// end of the last word are always zero
+struct Bitset : Object {
+  // the most bits a bitset may hold, 2 GiB of words
+  static constexpr size_t LIMIT = size_t(1) << 34;
+
+  Bitset(size_t bits);
+  Bitset(size_t bits, std::vector<uint64_t> words);
+
+  auto size() const -> size_t;
+  auto test(size_t i) const -> bool;
+  auto set(size_t i, bool value) -> void;
+  // first set bit at or after from, size() when there is none
+  auto next(size_t from) const -> size_t;
+  auto words() const -> std::span<const uint64_t>;
+  auto type() const -> ObjectType;
+  auto debug() const -> string;
+
+private:
+  std::vector<uint64_t> data;
+  size_t bits;
+};
+
+// ---------------------------------------
+// MATRIX TYPE
+// rows x cols floats stored contiguously in row-major order
+struct Matrix : Object {
+  // the most cells a matrix may hold, 2 GiB of floats
+  static constexpr size_t LIMIT = size_t(1) << 28;
+
+  Matrix(size_t rows, size_t cols);
+  Matrix(size_t rows, size_t cols, std::vector<double> values);
+
+  auto rows() const -> size_t;
+  auto cols() const -> size_t;
+  auto at(size_t i, size_t j) const -> double;
+  auto set(size_t i, size_t j, double value) -> void;
+  auto values() const -> std::span<const double>;
+  auto type() const -> ObjectType;
+  auto debug() const -> string;
+
+private:
+  size_t height;
+  size_t width;
+  std::vector<double> data;
+};
+
+// ---------------------------------------
+// REGEX TYPE
+// a compiled pattern, its dfa states are built up as it is used
+struct Regex : Object {
+  Regex(string pattern, std::shared_ptr<regex::Regex> compiled);
+
+  auto pattern() const -> string_view;
+  auto compiled() const -> regex::Regex &;
+  auto type() const -> ObjectType;
+  auto debug() const -> string;
+
+private:
+  string source;
+  std::shared_ptr<regex::Regex> program;
+};
+
+// ---------------------------------------
+// RANGE TYPE
+// the ints from start up to end, end excluded, step apart. a negative
+// step counts down. only the bounds are stored, never the ints
+struct Range : Object {
+  Range(int64_t start, int64_t end, int64_t step);
+
+  auto size() const -> size_t;
+  auto at(size_t i) const -> int64_t;
+  auto type() const -> ObjectType;
+  auto debug() const -> string;
+
+  int64_t start;
+  int64_t end;
+  int64_t step;
+};
+
+// ---------------------------------------
+// ITERATION
+// the elements of an array, a string or a range one at a time. the
+// elements are the ones there when iteration starts, changing the
+// collection meanwhile does not change them. another type becomes
+// iterable by handling it in iterable() and next()
+class Iterator {
+public:
+  static auto iterable(const std::shared_ptr<Object> &obj) -> bool;
+
+  Iterator(const std::shared_ptr<Object> &obj);
+
+  auto size() const -> size_t;
+  // stores the next element in out, false once there is none. an int
+  // in out that nothing else holds is overwritten instead of replaced
+  auto next(std::shared_ptr<Object> &out) -> bool;
+
+private:
+  std::shared_ptr<Object> items;
+  size_t pos;
+  size_t count;
 };
 
 // ---------------------------------------
@@ -123,6 +513,16 @@ struct Null : Object {
   auto debug() const -> string;
 };
 
+// ---------------------------------------
+// SHARED VALUES
+// a single null, true and false for the whole interpreter, whatever
+// produces one hands out these
+inline const std::shared_ptr<Object> OBJECT_NULL = std::make_shared<Null>();
+inline const std::shared_ptr<Object> OBJECT_TRUE =
+    std::make_shared<Bool>(true);
+inline const std::shared_ptr<Object> OBJECT_FALSE =
+    std::make_shared<Bool>(false);
+
 // ---------------------------------------
 // RETURN VALUE TYPE
 struct ReturnValue : Object {
@@ -163,6 +563,7 @@ typedef std::function<auto(const std::list<std::shared_ptr<Object>> &args)
     BuiltinFunction;
 
 struct Builtin : Object {
+  string name;
   BuiltinFunction fn;
 
   auto type() const -> ObjectType;
@@ -0,0 +1,498 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <object.hpp>
+#include <optional>
+
+using namespace object;
+
+struct object::OrderedTree {
+  virtual ~OrderedTree() = default;
+  virtual auto key_type() const -> ObjectType = 0;
+  virtual auto size() const -> size_t = 0;
+  virtual auto get(const std::shared_ptr<Object> &key) const
+      -> std::shared_ptr<Object> = 0;
+  virtual auto set(const std::shared_ptr<Object> &key,
+                   std::shared_ptr<Object> value) -> void = 0;
+  virtual auto remove(const std::shared_ptr<Object> &key) -> bool = 0;
+  virtual auto bound(const std::shared_ptr<Object> &key, bool inclusive) const
+      -> std::shared_ptr<Object> = 0;
+  virtual auto each(const std::shared_ptr<Object> &from,
+                    const std::shared_ptr<Object> &to,
+                    const OrderedMap::Visitor &fn) const -> void = 0;
+};
+
+namespace {
+// every node but the root holds between DEGREE - 1 and MAX_KEYS keys
+const size_t DEGREE = 16;
+const size_t MAX_KEYS = 2 * DEGREE - 1;
+
+using StringKey = std::shared_ptr<String>;
+
+auto before(int64_t lhs, int64_t rhs) -> bool { return lhs < rhs; }
+auto before(double lhs, double rhs) -> bool { return lhs < rhs; }
+auto before(const StringKey &lhs, const StringKey &rhs) -> bool {
+  return lhs->view() < rhs->view();
+}
+
+template <typename K> auto unbox(const std::shared_ptr<Object> &obj) -> K;
+
+template <> auto unbox<int64_t>(const std::shared_ptr<Object> &obj) -> int64_t {
+  return static_cast<const Integer &>(*obj).value;
+}
+
+template <> auto unbox<double>(const std::shared_ptr<Object> &obj) -> double {
+  return static_cast<const Float &>(*obj).value;
+}
+
+template <>
+auto unbox<StringKey>(const std::shared_ptr<Object> &obj) -> StringKey {
+  return object::cast<Object, String>(obj);
+}
+
+auto box(int64_t key) -> std::shared_ptr<Object> {
+  return std::make_shared<Integer>(key);
+}
+
+auto box(double key) -> std::shared_ptr<Object> {
+  return std::make_shared<Float>(key);
+}
+
+auto box(const StringKey &key) -> std::shared_ptr<Object> { return key; }
+
+// the key kept in the tree, strings get their own object so mutating
+// the caller's string later can't break the ordering
+auto own(int64_t key) -> int64_t { return key; }
+auto own(double key) -> double { return key; }
+auto own(const StringKey &key) -> StringKey {
+  return key->interned() ? key : key->substr(0, key->size());
+}
+
+template <typename K> class BTree : public OrderedTree {
+public:
+  BTree(ObjectType type) : type(type), root(std::make_unique<Node>()) {}
+
+  auto key_type() const -> ObjectType { return type; }
+  auto size() const -> size_t { return count; }
+
+  auto get(const std::shared_ptr<Object> &key) const
+      -> std::shared_ptr<Object> {
+    auto k = unbox<K>(key);
+    for (auto node = root.get();;) {
+      auto i = lower(*node, k);
+      if (i < node->count && !before(k, node->keys[i])) {
+        return node->values[i];
+      }
+
+      if (node->leaf) {
+        return nullptr;
+      }
+      node = node->children[i].get();
+    }
+  }
+
+  auto set(const std::shared_ptr<Object> &key, std::shared_ptr<Object> value)
+      -> void {
+    auto k = unbox<K>(key);
+    for (auto node = root.get();;) {
+      auto i = lower(*node, k);
+      if (i < node->count && !before(k, node->keys[i])) {
+        node->values[i] = std::move(value);
+        return;
+      }
+
+      if (node->leaf) {
+        break;
+      }
+      node = node->children[i].get();
+    }
+
+    // splitting full nodes on the way down keeps insertion single pass
+    if (root->count == MAX_KEYS) {
+      auto top = std::make_unique<Node>();
+      top->leaf = false;
+      top->children[0] = std::move(root);
+      root = std::move(top);
+      split(*root, 0);
+    }
+
+    auto node = root.get();
+    while (!node->leaf) {
+      auto i = upper(*node, k);
+      if (node->children[i]->count == MAX_KEYS) {
+        split(*node, i);
+        if (before(node->keys[i], k)) {
+          i++;
+        }
+      }
+      node = node->children[i].get();
+    }
+
+    auto i = upper(*node, k);
+    shift_right(*node, i);
+    node->keys[i] = own(k);
+    node->values[i] = std::move(value);
+    node->count++;
+    count++;
+  }
+
+  auto remove(const std::shared_ptr<Object> &key) -> bool {
+    if (!get(key)) {
+      return false;
+    }
+
+    erase(*root, unbox<K>(key));
+    if (root->count == 0 && !root->leaf) {
+      root = std::move(root->children[0]);
+    }
+    count--;
+    return true;
+  }
+
+  auto bound(const std::shared_ptr<Object> &key, bool inclusive) const
+      -> std::shared_ptr<Object> {
+    auto k = unbox<K>(key);
+    const K *best = nullptr;
+    for (auto node = root.get(); node;) {
+      auto i = inclusive ? lower(*node, k) : upper(*node, k);
+      if (i < node->count) {
+        best = &node->keys[i];
+        if (inclusive && !before(k, node->keys[i])) {
+          break;
+        }
+      }
+      node = node->leaf ? nullptr : node->children[i].get();
+    }
+
+    return best ? box(*best) : nullptr;
+  }
+
+  auto each(const std::shared_ptr<Object> &from,
+            const std::shared_ptr<Object> &to,
+            const OrderedMap::Visitor &fn) const -> void {
+    auto lo = from ? std::optional<K>(unbox<K>(from)) : std::nullopt;
+    auto hi = to ? std::optional<K>(unbox<K>(to)) : std::nullopt;
+    visit(*root, lo ? &*lo : nullptr, hi ? &*hi : nullptr, fn);
+  }
+
+private:
+  struct Node {
+    size_t count = 0;
+    bool leaf = true;
+    std::array<K, MAX_KEYS> keys;
+    std::array<std::shared_ptr<Object>, MAX_KEYS> values;
+    std::array<std::unique_ptr<Node>, MAX_KEYS + 1> children;
+  };
+
+  static auto lower(const Node &node, const K &key) -> size_t {
+    auto end = node.keys.begin() + node.count;
+    return std::lower_bound(node.keys.begin(), end, key,
+                            [](const K &a, const K &b) {
+                              return before(a, b);
+                            }) -
+           node.keys.begin();
+  }
+
+  static auto upper(const Node &node, const K &key) -> size_t {
+    auto end = node.keys.begin() + node.count;
+    return std::upper_bound(node.keys.begin(), end, key,
+                            [](const K &a, const K &b) {
+                              return before(a, b);
+                            }) -
+           node.keys.begin();
+  }
+
+  // opens a gap for a key at i, children are left alone
+  static auto shift_right(Node &node, size_t i) -> void {
+    std::move_backward(node.keys.begin() + i, node.keys.begin() + node.count,
+                       node.keys.begin() + node.count + 1);
+    std::move_backward(node.values.begin() + i,
+                       node.values.begin() + node.count,
+                       node.values.begin() + node.count + 1);
+  }
+
+  // closes the gap of the key at i, children are left alone
+  static auto shift_left(Node &node, size_t i) -> void {
+    std::move(node.keys.begin() + i + 1, node.keys.begin() + node.count,
+              node.keys.begin() + i);
+    std::move(node.values.begin() + i + 1, node.values.begin() + node.count,
+              node.values.begin() + i);
+  }
+
+  // moves the upper half of the full child i into a new sibling and
+  // its middle key up into parent
+  static auto split(Node &parent, size_t i) -> void {
+    auto &child = *parent.children[i];
+    auto sibling = std::make_unique<Node>();
+    sibling->leaf = child.leaf;
+    sibling->count = DEGREE - 1;
+    std::move(child.keys.begin() + DEGREE, child.keys.end(),
+              sibling->keys.begin());
+    std::move(child.values.begin() + DEGREE, child.values.end(),
+              sibling->values.begin());
+    if (!child.leaf) {
+      std::move(child.children.begin() + DEGREE, child.children.end(),
+                sibling->children.begin());
+    }
+    child.count = DEGREE - 1;
+
+    shift_right(parent, i);
+    std::move_backward(parent.children.begin() + i + 1,
+                       parent.children.begin() + parent.count + 1,
+                       parent.children.begin() + parent.count + 2);
+    parent.keys[i] = std::move(child.keys[DEGREE - 1]);
+    parent.values[i] = std::move(child.values[DEGREE - 1]);
+    parent.children[i + 1] = std::move(sibling);
+    parent.count++;
+  }
+
+  // folds the key at i and child i + 1 into child i
+  static auto merge(Node &parent, size_t i) -> void {
+    auto &left = *parent.children[i];
+    auto &right = *parent.children[i + 1];
+
+    left.keys[left.count] = std::move(parent.keys[i]);
+    left.values[left.count] = std::move(parent.values[i]);
+    std::move(right.keys.begin(), right.keys.begin() + right.count,
+              left.keys.begin() + left.count + 1);
+    std::move(right.values.begin(), right.values.begin() + right.count,
+              left.values.begin() + left.count + 1);
+    if (!left.leaf) {
+      std::move(right.children.begin(),
+                right.children.begin() + right.count + 1,
+                left.children.begin() + left.count + 1);
+    }
+    left.count += right.count + 1;
+
+    shift_left(parent, i);
+    std::move(parent.children.begin() + i + 2,
+              parent.children.begin() + parent.count + 1,
+              parent.children.begin() + i + 1);
+    parent.count--;
+  }
+
+  // makes sure child i can lose a key, returns where the keys that
+  // were in child i now live
+  static auto fill(Node &parent, size_t i) -> size_t {
+    if (i > 0 && parent.children[i - 1]->count >= DEGREE) {
+      auto &child = *parent.children[i];
+      auto &sibling = *parent.children[i - 1];
+      shift_right(child, 0);
+      if (!child.leaf) {
+        std::move_backward(child.children.begin(),
+                           child.children.begin() + child.count + 1,
+                           child.children.begin() + child.count + 2);
+        child.children[0] = std::move(sibling.children[sibling.count]);
+      }
+      child.keys[0] = std::move(parent.keys[i - 1]);
+      child.values[0] = std::move(parent.values[i - 1]);
+      parent.keys[i - 1] = std::move(sibling.keys[sibling.count - 1]);
+      parent.values[i - 1] = std::move(sibling.values[sibling.count - 1]);
+      sibling.count--;
+      child.count++;
+      return i;
+    }
+
+    if (i < parent.count && parent.children[i + 1]->count >= DEGREE) {
+      auto &child = *parent.children[i];
+      auto &sibling = *parent.children[i + 1];
+      child.keys[child.count] = std::move(parent.keys[i]);
+      child.values[child.count] = std::move(parent.values[i]);
+      if (!child.leaf) {
+        child.children[child.count + 1] = std::move(sibling.children[0]);
+        std::move(sibling.children.begin() + 1,
+                  sibling.children.begin() + sibling.count + 1,
+                  sibling.children.begin());
+      }
+      parent.keys[i] = std::move(sibling.keys[0]);
+      parent.values[i] = std::move(sibling.values[0]);
+      shift_left(sibling, 0);
+      sibling.count--;
+      child.count++;
+      return i;
+    }
+
+    if (i < parent.count) {
+      merge(parent, i);
+      return i;
+    }
+
+    merge(parent, i - 1);
+    return i - 1;
+  }
+
+  // the key is known to be in the subtree, every node entered keeps at
+  // least DEGREE keys so removing one never underflows it
+  static auto erase(Node &node, const K &key) -> void {
+    auto i = lower(node, key);
+    if (i < node.count && !before(key, node.keys[i])) {
+      if (node.leaf) {
+        shift_left(node, i);
+        node.count--;
+        return;
+      }
+
+      if (node.children[i]->count >= DEGREE) {
+        auto pred = node.children[i].get();
+        while (!pred->leaf) {
+          pred = pred->children[pred->count].get();
+        }
+        node.keys[i] = pred->keys[pred->count - 1];
+        node.values[i] = pred->values[pred->count - 1];
+        erase(*node.children[i], node.keys[i]);
+        return;
+      }
+
+      if (node.children[i + 1]->count >= DEGREE) {
+        auto succ = node.children[i + 1].get();
+        while (!succ->leaf) {
+          succ = succ->children[0].get();
+        }
+        node.keys[i] = succ->keys[0];
+        node.values[i] = succ->values[0];
+        erase(*node.children[i + 1], node.keys[i]);
+        return;
+      }
+
+      merge(node, i);
+      erase(*node.children[i], key);
+      return;
+    }
+
+    if (node.leaf) {
+      return;
+    }
+
+    if (node.children[i]->count < DEGREE) {
+      i = fill(node, i);
+    }
+    erase(*node.children[i], key);
+  }
+
+  static auto visit(const Node &node, const K *lo, const K *hi,
+                    const OrderedMap::Visitor &fn) -> bool {
+    for (auto i = lo ? lower(node, *lo) : 0; i <= node.count; i++) {
+      if (!node.leaf && !visit(*node.children[i], lo, hi, fn)) {
+        return false;
+      }
+
+      if (i == node.count) {
+        break;
+      }
+
+      if (hi && !before(node.keys[i], *hi)) {
+        return false;
+      }
+
+      if (!fn(box(node.keys[i]), node.values[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  ObjectType type;
+  std::unique_ptr<Node> root;
+  size_t count = 0;
+};
+}; // namespace
+
+OrderedMap::OrderedMap() = default;
+OrderedMap::~OrderedMap() = default;
+
+auto OrderedMap::orderable(const std::shared_ptr<Object> &key) -> bool {
+  switch (key->type()) {
+  case ObjectType::OINT:
+  case ObjectType::OSTRING:
+    return true;
+
+  case ObjectType::OFLOAT:
+    return !std::isnan(static_cast<const Float &>(*key).value);
+
+  default:
+    return false;
+  }
+}
+
+auto OrderedMap::accepts(const std::shared_ptr<Object> &key) const -> bool {
+  return orderable(key) && (!tree || tree->key_type() == key->type());
+}
+
+auto OrderedMap::size() const -> size_t { return tree ? tree->size() : 0; }
+
+auto OrderedMap::get(const std::shared_ptr<Object> &key) const
+    -> std::shared_ptr<Object> {
+  return tree ? tree->get(key) : nullptr;
+}
+
+auto OrderedMap::set(std::shared_ptr<Object> key,
+                     std::shared_ptr<Object> value) -> void {
+  if (!tree) {
+    switch (key->type()) {
+    case ObjectType::OINT:
+      tree = std::make_unique<BTree<int64_t>>(ObjectType::OINT);
+      break;
+
+    case ObjectType::OFLOAT:
+      tree = std::make_unique<BTree<double>>(ObjectType::OFLOAT);
+      break;
+
+    default:
+      tree = std::make_unique<BTree<StringKey>>(ObjectType::OSTRING);
+      break;
+    }
+  }
+
+  tree->set(key, std::move(value));
+}
+
+auto OrderedMap::remove(const std::shared_ptr<Object> &key) -> bool {
+  return tree ? tree->remove(key) : false;
+}
+
+auto OrderedMap::lower_bound(const std::shared_ptr<Object> &key) const
+    -> std::shared_ptr<Object> {
+  return tree ? tree->bound(key, true) : nullptr;
+}
+
+auto OrderedMap::upper_bound(const std::shared_ptr<Object> &key) const
+    -> std::shared_ptr<Object> {
+  return tree ? tree->bound(key, false) : nullptr;
+}
+
+auto OrderedMap::each(const std::shared_ptr<Object> &from,
+                      const std::shared_ptr<Object> &to,
+                      const Visitor &fn) const -> void {
+  if (!tree) {
+    return;
+  }
+
+  visitors++;
+  tree->each(from, to, fn);
+  visitors--;
+}
+
+auto OrderedMap::visiting() const -> bool { return visitors > 0; }
+
+auto OrderedMap::type() const -> ObjectType { return ObjectType::OMAP; }
+auto OrderedMap::debug() const -> string {
+  auto quote = [](const std::shared_ptr<Object> &obj) {
+    return obj->type() == ObjectType::OSTRING ? '"' + obj->debug() + '"'
+                                              : obj->debug();
+  };
+
+  string res = "{";
+  each(nullptr, nullptr, [&](const auto &key, const auto &value) {
+    if (res.size() > 1) {
+      res += ", ";
+    }
+    res += quote(key) + ": " + quote(value);
+    return true;
+  });
+  res += '}';
+
+  return res;
+}
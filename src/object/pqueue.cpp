@@ -0,0 +1,236 @@
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <memory>
+#include <object.hpp>
+#include <utility>
+#include <variant>
+#include <vector>
+
+using namespace object;
+
+namespace {
+template <typename T, typename Before>
+auto sift_up(std::vector<T> &heap, size_t i, const Before &before) -> void {
+  auto value = std::move(heap[i]);
+  while (i > 0) {
+    auto parent = (i - 1) / 2;
+    if (!before(value, heap[parent])) {
+      break;
+    }
+    heap[i] = std::move(heap[parent]);
+    i = parent;
+  }
+  heap[i] = std::move(value);
+}
+
+template <typename T, typename Before>
+auto sift_down(std::vector<T> &heap, const Before &before) -> void {
+  auto value = std::move(heap.front());
+  size_t i = 0;
+  for (;;) {
+    auto child = 2 * i + 1;
+    if (child >= heap.size()) {
+      break;
+    }
+    if (child + 1 < heap.size() && before(heap[child + 1], heap[child])) {
+      child++;
+    }
+    if (!before(heap[child], value)) {
+      break;
+    }
+    heap[i] = std::move(heap[child]);
+    i = child;
+  }
+  heap[i] = std::move(value);
+}
+
+template <typename T, typename Before>
+auto take(std::vector<T> &heap, const Before &before) -> T {
+  auto res = std::move(heap.front());
+  auto last = std::move(heap.back());
+  heap.pop_back();
+  if (!heap.empty()) {
+    heap.front() = std::move(last);
+    sift_down(heap, before);
+  }
+  return res;
+}
+
+auto number(const Object &obj) -> double {
+  return obj.type() == ObjectType::OINT
+             ? static_cast<double>(static_cast<const Integer &>(obj).value)
+             : static_cast<const Float &>(obj).value;
+}
+
+// natural order of boxed elements, accepts() keeps strings and
+// numbers apart
+auto natural(const std::shared_ptr<Object> &lhs,
+             const std::shared_ptr<Object> &rhs) -> bool {
+  auto lt = lhs->type();
+  auto rt = rhs->type();
+  if (lt == ObjectType::OSTRING) {
+    return static_cast<const String &>(*lhs).view() <
+           static_cast<const String &>(*rhs).view();
+  }
+
+  if (lt == ObjectType::OINT && rt == ObjectType::OINT) {
+    return static_cast<const Integer &>(*lhs).value <
+           static_cast<const Integer &>(*rhs).value;
+  }
+
+  return number(*lhs) < number(*rhs);
+}
+
+auto less = [](auto lhs, auto rhs) { return lhs < rhs; };
+}; // namespace
+
+PriorityQueue::PriorityQueue() : heap(Ints()) {}
+PriorityQueue::PriorityQueue(std::shared_ptr<Object> comparator)
+    : cmp(std::move(comparator)), heap(Boxed()) {}
+
+auto PriorityQueue::orderable(const std::shared_ptr<Object> &obj) -> bool {
+  auto type = obj->type();
+  return type == ObjectType::OINT || type == ObjectType::OFLOAT ||
+         type == ObjectType::OSTRING;
+}
+
+auto PriorityQueue::accepts(const std::shared_ptr<Object> &obj) const
+    -> bool {
+  if (cmp) {
+    return true;
+  }
+
+  if (!orderable(obj)) {
+    return false;
+  }
+
+  if (size() == 0) {
+    return true;
+  }
+
+  return (obj->type() == ObjectType::OSTRING) ==
+         (at(0)->type() == ObjectType::OSTRING);
+}
+
+auto PriorityQueue::comparator() const -> const std::shared_ptr<Object> & {
+  return cmp;
+}
+
+auto PriorityQueue::size() const -> size_t {
+  return std::visit([](const auto &h) { return h.size(); }, heap);
+}
+
+auto PriorityQueue::at(size_t i) const -> std::shared_ptr<Object> {
+  if (auto *ints = std::get_if<Ints>(&heap)) {
+    return std::make_shared<Integer>((*ints)[i]);
+  }
+  if (auto *floats = std::get_if<Floats>(&heap)) {
+    return std::make_shared<Float>((*floats)[i]);
+  }
+  return std::get<Boxed>(heap)[i];
+}
+
+auto PriorityQueue::push(std::shared_ptr<Object> obj) -> void {
+  fit(obj);
+  if (auto *ints = std::get_if<Ints>(&heap)) {
+    ints->push_back(static_cast<const Integer &>(*obj).value);
+    sift_up(*ints, ints->size() - 1, less);
+  } else if (auto *floats = std::get_if<Floats>(&heap)) {
+    floats->push_back(static_cast<const Float &>(*obj).value);
+    sift_up(*floats, floats->size() - 1, less);
+  } else {
+    auto &boxed = std::get<Boxed>(heap);
+    boxed.push_back(std::move(obj));
+    sift_up(boxed, boxed.size() - 1, natural);
+  }
+}
+
+auto PriorityQueue::push(std::shared_ptr<Object> obj, const Before &before)
+    -> void {
+  auto &boxed = std::get<Boxed>(heap);
+  boxed.push_back(std::move(obj));
+  busy = true;
+  sift_up(boxed, boxed.size() - 1, before);
+  busy = false;
+}
+
+auto PriorityQueue::pop() -> std::shared_ptr<Object> {
+  if (auto *ints = std::get_if<Ints>(&heap)) {
+    return std::make_shared<Integer>(take(*ints, less));
+  }
+  if (auto *floats = std::get_if<Floats>(&heap)) {
+    return std::make_shared<Float>(take(*floats, less));
+  }
+  return take(std::get<Boxed>(heap), natural);
+}
+
+auto PriorityQueue::pop(const Before &before) -> std::shared_ptr<Object> {
+  busy = true;
+  auto res = take(std::get<Boxed>(heap), before);
+  busy = false;
+  return res;
+}
+
+auto PriorityQueue::restore(std::shared_ptr<Object> comparator,
+                            Boxed elements) -> bool {
+  cmp = std::move(comparator);
+  if (cmp) {
+    heap = std::move(elements);
+    return true;
+  }
+
+  heap = Ints();
+  for (auto &obj : elements) {
+    if (!accepts(obj)) {
+      return false;
+    }
+
+    fit(obj);
+    if (auto *ints = std::get_if<Ints>(&heap)) {
+      ints->push_back(static_cast<const Integer &>(*obj).value);
+    } else if (auto *floats = std::get_if<Floats>(&heap)) {
+      floats->push_back(static_cast<const Float &>(*obj).value);
+    } else {
+      std::get<Boxed>(heap).push_back(std::move(obj));
+    }
+  }
+  return true;
+}
+
+auto PriorityQueue::ordering() const -> bool { return busy; }
+
+// same as Array::fit, an empty heap takes the packing of its first
+// element and a mismatch boxes it for good
+auto PriorityQueue::fit(const std::shared_ptr<Object> &obj) -> void {
+  auto type = obj->type();
+  if (size() == 0) {
+    if (type == ObjectType::OINT) {
+      heap = Ints();
+    } else if (type == ObjectType::OFLOAT) {
+      heap = Floats();
+    } else {
+      heap = Boxed();
+    }
+    return;
+  }
+
+  if (std::holds_alternative<Boxed>(heap) ||
+      (std::holds_alternative<Ints>(heap) && type == ObjectType::OINT) ||
+      (std::holds_alternative<Floats>(heap) && type == ObjectType::OFLOAT)) {
+    return;
+  }
+
+  // storage order of a heap stays a valid heap after boxing
+  auto boxed = Boxed();
+  boxed.reserve(size() + 1);
+  for (size_t i = 0; i < size(); i++) {
+    boxed.push_back(at(i));
+  }
+  heap = std::move(boxed);
+}
+
+auto PriorityQueue::type() const -> ObjectType { return ObjectType::OPQUEUE; }
+auto PriorityQueue::debug() const -> string {
+  return std::format("pq({})", size());
+}
@@ -1,7 +1,9 @@
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <format>
+#include <functional>
 #include <object.hpp>
 #include <ranges>
 
@@ -22,22 +24,323 @@ Bool::Bool(bool value) { this->value = value; }
 auto Bool::type() const -> ObjectType { return ObjectType::OBOOL; }
 auto Bool::debug() const -> string { return std::format("{}", value); }
 
-String::String() { value = ""; }
-String::String(string value) { this->value = value; }
+String::String() : String(string()) {}
+String::String(string value) {
+  length = value.size();
+  offset = 0;
+  buffer = std::make_shared<string>(std::move(value));
+}
+
+auto String::view() const -> string_view {
+  return string_view(buffer->data() + offset, length);
+}
+
+auto String::size() const -> size_t { return length; }
+
+auto String::substr(size_t pos, size_t count) const
+    -> std::shared_ptr<String> {
+  auto res = std::make_shared<String>(*this);
+  res->constant = false;
+  res->has_hash = false;
+  res->offset = offset + pos;
+  res->length = count;
+  return res;
+}
+
+auto String::concat(string_view rhs) const -> std::shared_ptr<String> {
+  auto res = std::make_shared<String>(*this);
+  res->constant = false;
+  res->append(rhs);
+  return res;
+}
+
+auto String::append(string_view rhs) -> void {
+  // somebody else's bytes follow this window, start a buffer of our own
+  if (offset + length != buffer->size()) {
+    auto grown = string();
+    grown.reserve(std::max(2 * length, length + rhs.size()));
+    grown += view();
+    buffer = std::make_shared<string>(std::move(grown));
+    offset = 0;
+  }
+
+  auto data = std::less_equal<const char *>();
+  if (data(buffer->data(), rhs.data()) &&
+      data(rhs.data(), buffer->data() + buffer->size())) {
+    auto copy = string(rhs);
+    buffer->append(copy);
+  } else {
+    buffer->append(rhs);
+  }
+  length += rhs.size();
+  has_hash = false;
+}
+
+// copy-on-write, the buffer may be shared with other strings
+auto String::set(size_t i, char c) -> void {
+  if (buffer.use_count() != 1) {
+    buffer = std::make_shared<string>(view());
+    offset = 0;
+  }
+
+  (*buffer)[offset + i] = c;
+  has_hash = false;
+}
+
+auto String::interned() const -> bool { return constant; }
+
+// cached, dictionary lookups with the same key object hash it once
+auto String::hash() const -> uint64_t {
+  if (!has_hash) {
+    hashed = std::hash<string_view>{}(view());
+    has_hash = true;
+  }
+  return hashed;
+}
+
 auto String::type() const -> ObjectType { return ObjectType::OSTRING; }
-auto String::debug() const -> string { return std::format("{}", value); }
+auto String::debug() const -> string { return string(view()); }
+
+auto Strings::intern(string_view value) -> const std::shared_ptr<String> & {
+  if (auto it = table.find(value); it != table.end()) {
+    return it->second;
+  }
+
+  auto res = std::make_shared<String>(string(value));
+  res->constant = true;
+  return table.emplace(string(value), std::move(res)).first->second;
+}
+
+Array::Array() : Array(Boxed{}) {}
+Array::Array(Boxed elements) {
+  length = elements.size();
+  offset = 0;
+
+  auto all = [&](ObjectType type) {
+    return !elements.empty() &&
+           std::ranges::all_of(elements, [&](const auto &e) {
+             return e->type() == type;
+           });
+  };
+
+  if (all(ObjectType::OINT)) {
+    auto packed = Ints();
+    packed.reserve(length);
+    for (const auto &e : elements) {
+      packed.push_back(static_cast<const Integer &>(*e).value);
+    }
+    storage = std::make_shared<Storage>(std::move(packed));
+  } else if (all(ObjectType::OFLOAT)) {
+    auto packed = Floats();
+    packed.reserve(length);
+    for (const auto &e : elements) {
+      packed.push_back(static_cast<const Float &>(*e).value);
+    }
+    storage = std::make_shared<Storage>(std::move(packed));
+  } else {
+    storage = std::make_shared<Storage>(std::move(elements));
+  }
+}
+
+Array::Array(Ints elements) {
+  length = elements.size();
+  offset = 0;
+  storage = std::make_shared<Storage>(std::move(elements));
+}
+
+Array::Array(Floats elements) {
+  length = elements.size();
+  offset = 0;
+  storage = std::make_shared<Storage>(std::move(elements));
+}
+
+Array::Array(std::shared_ptr<Mapping> mapping)
+    : mapping(std::move(mapping)), offset(0), length(this->mapping->count) {}
+
+auto Array::size() const -> size_t { return length; }
+
+auto Array::at(size_t i) const -> std::shared_ptr<Object> {
+  if (mapping) {
+    if (mapping->kind == Mapping::Kind::INTS) {
+      return std::make_shared<Integer>(
+          static_cast<const int64_t *>(mapping->data)[offset + i]);
+    }
+    return std::make_shared<Float>(
+        static_cast<const double *>(mapping->data)[offset + i]);
+  }
+
+  if (auto ints = std::get_if<Ints>(storage.get())) {
+    return std::make_shared<Integer>((*ints)[offset + i]);
+  }
+
+  if (auto floats = std::get_if<Floats>(storage.get())) {
+    return std::make_shared<Float>((*floats)[offset + i]);
+  }
+
+  return std::get<Boxed>(*storage)[offset + i];
+}
+
+auto Array::set(size_t i, std::shared_ptr<Object> obj) -> void {
+  // a writable mapping no other array looks at is written in place
+  if (mapping) {
+    auto ints = mapping->kind == Mapping::Kind::INTS;
+    auto type = ints ? ObjectType::OINT : ObjectType::OFLOAT;
+    if (mapping->writable && mapping.use_count() == 1 &&
+        obj->type() == type) {
+      if (ints) {
+        static_cast<int64_t *>(mapping->data)[offset + i] =
+            static_cast<const Integer &>(*obj).value;
+      } else {
+        static_cast<double *>(mapping->data)[offset + i] =
+            static_cast<const Float &>(*obj).value;
+      }
+      return;
+    }
+    unmap();
+  }
+
+  fit(obj);
+  own();
+
+  if (auto ints = std::get_if<Ints>(storage.get())) {
+    (*ints)[i] = static_cast<const Integer &>(*obj).value;
+  } else if (auto floats = std::get_if<Floats>(storage.get())) {
+    (*floats)[i] = static_cast<const Float &>(*obj).value;
+  } else {
+    std::get<Boxed>(*storage)[i] = std::move(obj);
+  }
+}
+
+auto Array::push(std::shared_ptr<Object> obj) -> void {
+  if (mapping) {
+    unmap();
+  }
+  fit(obj);
+  own();
+
+  if (auto ints = std::get_if<Ints>(storage.get())) {
+    ints->push_back(static_cast<const Integer &>(*obj).value);
+  } else if (auto floats = std::get_if<Floats>(storage.get())) {
+    floats->push_back(static_cast<const Float &>(*obj).value);
+  } else {
+    std::get<Boxed>(*storage).push_back(std::move(obj));
+  }
+  length++;
+}
+
+auto Array::pop() -> void {
+  if (mapping) {
+    unmap();
+  }
+  own();
+  std::visit([](auto &elements) { elements.pop_back(); }, *storage);
+  length--;
+}
+
+auto Array::slice(size_t start, size_t end) const -> std::shared_ptr<Array> {
+  auto res = std::make_shared<Array>(*this);
+  res->offset = offset + start;
+  res->length = end - start;
+  return res;
+}
+
+auto Array::ints() const -> std::optional<std::span<const int64_t>> {
+  if (mapping && mapping->kind == Mapping::Kind::INTS) {
+    return std::span<const int64_t>(
+        static_cast<const int64_t *>(mapping->data) + offset, length);
+  }
+  if (auto ints = std::get_if<Ints>(storage.get())) {
+    return std::span<const int64_t>(ints->data() + offset, length);
+  }
+  return std::nullopt;
+}
+
+auto Array::floats() const -> std::optional<std::span<const double>> {
+  if (mapping && mapping->kind == Mapping::Kind::FLOATS) {
+    return std::span<const double>(
+        static_cast<const double *>(mapping->data) + offset, length);
+  }
+  if (auto floats = std::get_if<Floats>(storage.get())) {
+    return std::span<const double>(floats->data() + offset, length);
+  }
+  return std::nullopt;
+}
+
+// copy-on-write, afterwards this array is the only user of
+// its storage and the window covers all of it
+auto Array::own() -> void {
+  auto size = std::visit([](const auto &e) { return e.size(); }, *storage);
+  if (storage.use_count() == 1 && offset == 0 && length == size) {
+    return;
+  }
+
+  storage = std::visit(
+      [&](const auto &elements) {
+        auto begin = elements.begin() + offset;
+        return std::make_shared<Storage>(
+            std::decay_t<decltype(elements)>(begin, begin + length));
+      },
+      *storage);
+  offset = 0;
+}
+
+// picks the storage obj can live in: an empty array repacks for the
+// type of its first element, a packed array obj doesn't fit gets boxed
+auto Array::fit(const std::shared_ptr<Object> &obj) -> void {
+  auto type = obj->type();
+  if (length == 0) {
+    if (type == ObjectType::OINT) {
+      storage = std::make_shared<Storage>(Ints());
+    } else if (type == ObjectType::OFLOAT) {
+      storage = std::make_shared<Storage>(Floats());
+    } else {
+      storage = std::make_shared<Storage>(Boxed());
+    }
+    offset = 0;
+    return;
+  }
+
+  if (std::holds_alternative<Boxed>(*storage) ||
+      (std::holds_alternative<Ints>(*storage) && type == ObjectType::OINT) ||
+      (std::holds_alternative<Floats>(*storage) &&
+       type == ObjectType::OFLOAT)) {
+    return;
+  }
+
+  auto boxed = Boxed();
+  boxed.reserve(length + 1);
+  for (size_t i = 0; i < length; i++) {
+    boxed.push_back(at(i));
+  }
+  storage = std::make_shared<Storage>(std::move(boxed));
+  offset = 0;
+}
+
+// copies the window of the mapped file into packed storage
+auto Array::unmap() -> void {
+  if (auto ints = this->ints()) {
+    storage = std::make_shared<Storage>(Ints(ints->begin(), ints->end()));
+  } else {
+    auto floats = this->floats().value();
+    storage =
+        std::make_shared<Storage>(Floats(floats.begin(), floats.end()));
+  }
+  mapping.reset();
+  offset = 0;
+}
 
 auto Array::type() const -> ObjectType { return ObjectType::OARRAY; }
 auto Array::debug() const -> string {
   string res = "[";
-  for (const auto &[i, e] : elements | std::views::enumerate) {
+  for (size_t i = 0; i < length; i++) {
+    auto e = at(i);
     if (e->type() == ObjectType::OSTRING) {
       res += '"' + e->debug() + '"';
     } else {
       res += e->debug();
     }
 
-    if (elements.size() - 1 != (size_t)i) {
+    if (length - 1 != i) {
       res += ", ";
     }
   }
@@ -0,0 +1,104 @@
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <memory>
+#include <object.hpp>
+
+using namespace object;
+
+Range::Range(int64_t start, int64_t end, int64_t step)
+    : start(start), end(end), step(step) {}
+
+// the distance between the bounds is taken unsigned, it does not fit
+// an int64 when they are far apart
+auto Range::size() const -> size_t {
+  if (step > 0 && start < end) {
+    auto span = static_cast<uint64_t>(end) - static_cast<uint64_t>(start);
+    return (span - 1) / static_cast<uint64_t>(step) + 1;
+  }
+  if (step < 0 && start > end) {
+    auto span = static_cast<uint64_t>(start) - static_cast<uint64_t>(end);
+    return (span - 1) / (0 - static_cast<uint64_t>(step)) + 1;
+  }
+  return 0;
+}
+
+auto Range::at(size_t i) const -> int64_t {
+  return static_cast<int64_t>(static_cast<uint64_t>(start) +
+                              i * static_cast<uint64_t>(step));
+}
+
+auto Range::type() const -> ObjectType { return ObjectType::ORANGE; }
+auto Range::debug() const -> string {
+  return std::format("range({}, {}, {})", start, end, step);
+}
+
+auto Iterator::iterable(const std::shared_ptr<Object> &obj) -> bool {
+  switch (obj->type()) {
+  case ObjectType::OARRAY:
+  case ObjectType::OSTRING:
+  case ObjectType::ORANGE:
+    return true;
+
+  default:
+    return false;
+  }
+}
+
+// arrays and strings are iterated through a view of their current
+// contents, writes to the original copy it first
+Iterator::Iterator(const std::shared_ptr<Object> &obj) : pos(0), count(0) {
+  switch (obj->type()) {
+  case ObjectType::OARRAY: {
+    auto arr = object::cast<Object, Array>(obj);
+    count = arr->size();
+    items = arr->slice(0, count);
+    break;
+  }
+
+  case ObjectType::OSTRING: {
+    auto str = object::cast<Object, String>(obj);
+    count = str->size();
+    items = str->substr(0, count);
+    break;
+  }
+
+  case ObjectType::ORANGE:
+    count = static_cast<const Range &>(*obj).size();
+    items = obj;
+    break;
+
+  default:
+    break;
+  }
+}
+
+auto Iterator::size() const -> size_t { return count; }
+
+auto Iterator::next(std::shared_ptr<Object> &out) -> bool {
+  if (pos == count) {
+    return false;
+  }
+
+  auto i = pos++;
+  switch (items->type()) {
+  case ObjectType::OARRAY:
+    out = static_cast<const Array &>(*items).at(i);
+    break;
+
+  case ObjectType::OSTRING:
+    out = static_cast<const String &>(*items).substr(i, 1);
+    break;
+
+  default: {
+    auto value = static_cast<const Range &>(*items).at(i);
+    if (out && out.use_count() == 1 && out->type() == ObjectType::OINT) {
+      static_cast<Integer &>(*out).value = value;
+    } else {
+      out = std::make_shared<Integer>(value);
+    }
+    break;
+  }
+  }
+  return true;
+}
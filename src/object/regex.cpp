@@ -0,0 +1,17 @@
+#include <format>
+#include <memory>
+#include <object.hpp>
+#include <utility>
+
+using namespace object;
+
+Regex::Regex(string pattern, std::shared_ptr<regex::Regex> compiled)
+    : source(std::move(pattern)), program(std::move(compiled)) {}
+
+auto Regex::pattern() const -> string_view { return source; }
+auto Regex::compiled() const -> regex::Regex & { return *program; }
+
+auto Regex::type() const -> ObjectType { return ObjectType::OREGEX; }
+auto Regex::debug() const -> string {
+  return std::format("regex(\"{}\")", source);
+}
@@ -47,6 +47,26 @@ auto Parser::parse_let(this Parser &self)
   return stmt;
 }
 
+auto Parser::parse_import(this Parser &self)
+    -> std::shared_ptr<ast::ImportStatement> {
+  auto stmt = std::make_shared<ast::ImportStatement>();
+  stmt->pos = self.lexer.get_last_position();
+
+  if (self.lexer.get_peek_token() != Token::TSTRING) {
+    self.register_error("expected a module path string");
+    return nullptr;
+  }
+
+  self.lexer.get_token();
+  stmt->path = std::any_cast<string>(self.lexer.get_value());
+
+  if (self.lexer.get_peek_token() == Token::TSEMICOLON) {
+    self.lexer.get_token();
+  }
+
+  return stmt;
+}
+
 auto Parser::parse_assignment(this Parser &self,
                               std::shared_ptr<ast::Expression> name)
     -> std::shared_ptr<ast::Expression> {
@@ -87,6 +107,8 @@ auto Parser::parse_statement(this Parser &self)
     return self.parse_let();
   case Token::TRETURN:
     return self.parse_return();
+  case Token::TIMPORT:
+    return self.parse_import();
   case Token::TERROR:
     self.register_error(std::any_cast<string>(self.lexer.get_value()));
     return nullptr;
@@ -1,9 +1,13 @@
+#include <any>
 #include <ast.hpp>
 #include <memory>
 #include <parser.hpp>
+#include <string>
 #include <token.hpp>
+#include <types.hpp>
 
 using namespace parser;
+using std::string;
 using token::Token;
 
 auto Parser::parse_return(this Parser &self)
@@ -73,6 +77,10 @@ auto Parser::parse_for(this Parser &self) -> std::shared_ptr<ast::Expression> {
   }
   self.lexer.get_token();
 
+  if (self.lexer.get_peek_token() == Token::TIDENTIFIER) {
+    return self.parse_for_in(expr->pos);
+  }
+
   // init
   if (self.lexer.get_peek_token() != Token::TSEMICOLON) {
     self.lexer.get_token();
@@ -108,3 +116,38 @@ auto Parser::parse_for(this Parser &self) -> std::shared_ptr<ast::Expression> {
   expr->body = self.parse_block();
   return expr;
 }
+
+// for (name in iterable) { body }, the opening parenthesis is read
+auto Parser::parse_for_in(this Parser &self, types::Position pos)
+    -> std::shared_ptr<ast::Expression> {
+  auto expr = std::make_shared<ast::ForInExpression>();
+  expr->pos = pos;
+
+  self.lexer.get_token();
+  expr->name = std::make_shared<ast::Identifier>();
+  expr->name->pos = self.lexer.get_last_position();
+  expr->name->value = std::any_cast<string>(self.lexer.get_value());
+
+  if (self.lexer.get_peek_token() != Token::TIN) {
+    self.register_error("expected in");
+    return nullptr;
+  }
+  self.lexer.get_token();
+  self.lexer.get_token();
+  expr->iterable = self.parse_expression(LOWEST);
+
+  if (self.lexer.get_peek_token() != Token::TCPAREN) {
+    self.register_error("expected )");
+    return nullptr;
+  }
+  self.lexer.get_token();
+
+  if (self.lexer.get_peek_token() != Token::TOCURLY) {
+    self.register_error("expected {");
+    return nullptr;
+  }
+  self.lexer.get_token();
+
+  expr->body = self.parse_block();
+  return expr;
+}
@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <analysis.hpp>
 #include <ast.hpp>
 #include <memory>
 #include <parser.hpp>
@@ -36,6 +37,8 @@ Parser::Parser(lexer::Lexer &lexer) : lexer(lexer) {
                            LAMDA_PREFIX(this->parse_func()));
   this->register_prefix_fn(token::Token::TOSQR,
                            LAMDA_PREFIX(this->parse_array()));
+  this->register_prefix_fn(token::Token::TOCURLY,
+                           LAMDA_PREFIX(this->parse_dict()));
 
   // INFIX
   this->register_infix_fn(
@@ -106,6 +109,7 @@ auto Parser::parse(this Parser &self) -> std::shared_ptr<ast::Program> {
     }
   }
 
+  analysis::run(program);
   return program;
 }
 
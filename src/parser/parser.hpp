@@ -70,6 +70,7 @@ private:
   auto parse_bool(this Parser &self) -> std::shared_ptr<ast::Expression>;
   auto parse_string(this Parser &self) -> std::shared_ptr<ast::Expression>;
   auto parse_array(this Parser &self) -> std::shared_ptr<ast::Expression>;
+  auto parse_dict(this Parser &self) -> std::shared_ptr<ast::Expression>;
   auto peek_precedence(this Parser &self) -> Precedence;
   auto curr_precedence(this Parser &self) -> Precedence;
   auto parse_prefix_expression(this Parser &self)
@@ -93,7 +94,10 @@ private:
       -> std::shared_ptr<ast::Expression>;
   auto parse_if(this Parser &self) -> std::shared_ptr<ast::Expression>;
   auto parse_for(this Parser &self) -> std::shared_ptr<ast::Expression>;
+  auto parse_for_in(this Parser &self, types::Position pos)
+      -> std::shared_ptr<ast::Expression>;
   auto parse_return(this Parser &self) -> std::shared_ptr<ast::ReturnStatement>;
+  auto parse_import(this Parser &self) -> std::shared_ptr<ast::ImportStatement>;
 
   auto parse_func_parameters(this Parser &self)
       -> std::vector<std::shared_ptr<ast::Identifier>>;
@@ -47,3 +47,45 @@ auto Parser::parse_array(this Parser &self)
   self.lexer.get_token();
   return lit;
 }
+
+auto Parser::parse_dict(this Parser &self)
+    -> std::shared_ptr<ast::Expression> {
+  auto lit = std::make_shared<ast::DictLiteral>();
+  lit->pos = self.lexer.get_position();
+  if (self.lexer.get_peek_token() == Token::TCCURLY) {
+    self.lexer.get_token();
+    return lit;
+  }
+
+  while (true) {
+    self.lexer.get_token();
+    auto key = self.parse_expression(Precedence::LOWEST);
+
+    if (self.lexer.get_peek_token() != Token::TCOLON) {
+      self.register_error("expected :");
+      return nullptr;
+    }
+
+    self.lexer.get_token();
+    self.lexer.get_token();
+    auto value = self.parse_expression(Precedence::LOWEST);
+    lit->pairs.emplace_back(std::move(key), std::move(value));
+
+    self.lexer.get_token();
+    if (self.lexer.get_last_token() == Token::TCCURLY) {
+      break;
+    }
+
+    if (self.lexer.get_last_token() != Token::TCOMMA) {
+      self.register_error("expected ,");
+      return nullptr;
+    }
+
+    if (self.lexer.get_peek_token() == Token::TCCURLY) {
+      self.lexer.get_token();
+      break;
+    }
+  }
+
+  return lit;
+}
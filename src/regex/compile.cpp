@@ -0,0 +1,550 @@
+#include <algorithm>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <format>
+#include <regex.hpp>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using namespace regex;
+
+namespace {
+// bounds counted repetitions and nesting, and with them the size of
+// the program a short pattern can expand to
+const uint32_t MAX_REPEAT = 1000;
+const uint32_t INF = UINT32_MAX;
+const size_t MAX_DEPTH = 1000;
+const size_t MAX_INSTS = 1 << 16;
+
+struct Node {
+  enum Kind : uint8_t { EMPTY, CLASS, BEGIN, END, CONCAT, ALT, REPEAT };
+
+  Kind kind;
+  uint32_t cls = 0;
+  uint32_t min = 0;
+  uint32_t max = 0;
+  std::vector<Node> children = {};
+};
+
+class Parser {
+public:
+  Parser(string_view pattern, std::vector<std::bitset<256>> &classes)
+      : pattern(pattern), classes(classes) {}
+
+  auto parse(this Parser &self) -> std::expected<Node, string> {
+    auto node = self.alt(0);
+    if (node.has_value() && self.pos < self.pattern.size()) {
+      return self.fail("unbalanced parenthesis");
+    }
+    return node;
+  }
+
+private:
+  auto fail(this const Parser &self, string_view msg)
+      -> std::unexpected<string> {
+    return std::unexpected(
+        std::format("invalid regex, {} at offset {}", msg, self.pos));
+  }
+
+  auto done(this const Parser &self) -> bool {
+    return self.pos >= self.pattern.size();
+  }
+
+  auto peek(this const Parser &self) -> char {
+    return self.pattern[self.pos];
+  }
+
+  auto add(this Parser &self, const std::bitset<256> &set) -> Node {
+    self.classes.push_back(set);
+    return Node{.kind = Node::CLASS,
+                .cls = static_cast<uint32_t>(self.classes.size() - 1)};
+  }
+
+  auto alt(this Parser &self, size_t depth) -> std::expected<Node, string> {
+    if (depth > MAX_DEPTH) {
+      return self.fail("pattern nests too deeply");
+    }
+
+    auto node = Node{.kind = Node::ALT};
+    for (;;) {
+      auto branch = self.concat(depth);
+      if (!branch.has_value()) {
+        return branch;
+      }
+      node.children.push_back(std::move(branch.value()));
+      if (self.done() || self.peek() != '|') {
+        break;
+      }
+      self.pos++;
+    }
+
+    if (node.children.size() == 1) {
+      return std::move(node.children.front());
+    }
+    return node;
+  }
+
+  auto concat(this Parser &self, size_t depth) -> std::expected<Node, string> {
+    auto node = Node{.kind = Node::CONCAT};
+    while (!self.done() && self.peek() != '|' && self.peek() != ')') {
+      auto atom = self.repeat(depth);
+      if (!atom.has_value()) {
+        return atom;
+      }
+      node.children.push_back(std::move(atom.value()));
+    }
+
+    if (node.children.empty()) {
+      return Node{.kind = Node::EMPTY};
+    }
+    if (node.children.size() == 1) {
+      return std::move(node.children.front());
+    }
+    return node;
+  }
+
+  auto repeat(this Parser &self, size_t depth) -> std::expected<Node, string> {
+    auto node = self.atom(depth);
+    if (!node.has_value()) {
+      return node;
+    }
+
+    while (!self.done()) {
+      uint32_t min = 0;
+      uint32_t max = INF;
+      auto c = self.peek();
+      if (c == '*') {
+        self.pos++;
+      } else if (c == '+') {
+        min = 1;
+        self.pos++;
+      } else if (c == '?') {
+        max = 1;
+        self.pos++;
+      } else if (c != '{') {
+        break;
+      } else {
+        auto counted = self.counts(min, max);
+        if (!counted.has_value()) {
+          return std::unexpected(counted.error());
+        }
+        if (!counted.value()) {
+          break;
+        }
+      }
+
+      if (!self.done() && self.peek() == '?') {
+        return self.fail("lazy quantifiers are not supported");
+      }
+
+      auto child = std::move(node.value());
+      node = Node{.kind = Node::REPEAT, .min = min, .max = max};
+      node->children.push_back(std::move(child));
+    }
+    return node;
+  }
+
+  // {n}, {n,} or {n,m}, anything else leaves the brace a literal
+  auto counts(this Parser &self, uint32_t &min, uint32_t &max)
+      -> std::expected<bool, string> {
+    auto number = [&](size_t &i, uint32_t &out) {
+      auto begin = i;
+      out = 0;
+      while (i < self.pattern.size() && self.pattern[i] >= '0' &&
+             self.pattern[i] <= '9') {
+        auto digit = static_cast<uint32_t>(self.pattern[i++] - '0');
+        out = std::min(out * 10 + digit, MAX_REPEAT + 1);
+      }
+      return i > begin;
+    };
+
+    auto i = self.pos + 1;
+    if (!number(i, min)) {
+      return false;
+    }
+    max = min;
+    if (i < self.pattern.size() && self.pattern[i] == ',') {
+      i++;
+      if (!number(i, max)) {
+        max = INF;
+      }
+    }
+    if (i >= self.pattern.size() || self.pattern[i] != '}') {
+      return false;
+    }
+    if (min > MAX_REPEAT || (max != INF && max > MAX_REPEAT)) {
+      return self.fail("repetition count is too large");
+    }
+    if (max < min) {
+      return self.fail("invalid repetition count");
+    }
+    self.pos = i + 1;
+    return true;
+  }
+
+  auto atom(this Parser &self, size_t depth) -> std::expected<Node, string> {
+    auto c = self.pattern[self.pos++];
+    switch (c) {
+    case '(': {
+      if (self.pattern.substr(self.pos).starts_with("?:")) {
+        self.pos += 2;
+      }
+      auto node = self.alt(depth + 1);
+      if (!node.has_value()) {
+        return node;
+      }
+      if (self.done() || self.peek() != ')') {
+        return self.fail("unbalanced parenthesis");
+      }
+      self.pos++;
+      return node;
+    }
+
+    case '[':
+      return self.bracket();
+
+    case '.': {
+      auto set = std::bitset<256>().set();
+      set.reset('\n');
+      return self.add(set);
+    }
+
+    case '^':
+      return Node{.kind = Node::BEGIN};
+
+    case '$':
+      return Node{.kind = Node::END};
+
+    case '*':
+    case '+':
+    case '?':
+      self.pos--;
+      return self.fail("nothing to repeat");
+
+    case '\\': {
+      auto set = std::bitset<256>();
+      auto res = self.escape(set);
+      if (!res.has_value()) {
+        return std::unexpected(res.error());
+      }
+      return self.add(set);
+    }
+
+    default: {
+      auto set = std::bitset<256>();
+      set.set(static_cast<uint8_t>(c));
+      return self.add(set);
+    }
+    }
+  }
+
+  // [abc], [^a-z], classes like \d work inside too
+  auto bracket(this Parser &self) -> std::expected<Node, string> {
+    auto set = std::bitset<256>();
+    auto negate = !self.done() && self.peek() == '^';
+    if (negate) {
+      self.pos++;
+    }
+
+    auto first = true;
+    for (;;) {
+      if (self.done()) {
+        return self.fail("unterminated character class");
+      }
+      if (self.peek() == ']' && !first) {
+        self.pos++;
+        break;
+      }
+      first = false;
+
+      auto lo = static_cast<uint8_t>(self.peek());
+      if (self.peek() == '\\') {
+        self.pos++;
+        auto item = std::bitset<256>();
+        auto res = self.escape(item);
+        if (!res.has_value()) {
+          return std::unexpected(res.error());
+        }
+        if (item.count() != 1) {
+          set |= item;
+          continue;
+        }
+        lo = static_cast<uint8_t>(res.value());
+      } else {
+        self.pos++;
+      }
+
+      if (self.pos + 1 < self.pattern.size() && self.peek() == '-' &&
+          self.pattern[self.pos + 1] != ']') {
+        self.pos++;
+        auto hi = static_cast<uint8_t>(self.peek());
+        if (self.peek() == '\\') {
+          self.pos++;
+          auto item = std::bitset<256>();
+          auto res = self.escape(item);
+          if (!res.has_value()) {
+            return std::unexpected(res.error());
+          }
+          if (item.count() != 1) {
+            return self.fail("invalid range");
+          }
+          hi = static_cast<uint8_t>(res.value());
+        } else {
+          self.pos++;
+        }
+        if (hi < lo) {
+          return self.fail("invalid range");
+        }
+        for (auto b = size_t(lo); b <= hi; b++) {
+          set.set(b);
+        }
+      } else {
+        set.set(lo);
+      }
+    }
+
+    if (negate) {
+      set.flip();
+    }
+    return self.add(set);
+  }
+
+  // the byte after a backslash, fills set with what it matches and
+  // returns the byte itself when it stands for a single one
+  auto escape(this Parser &self, std::bitset<256> &set)
+      -> std::expected<char, string> {
+    if (self.done()) {
+      return self.fail("trailing backslash");
+    }
+
+    auto c = self.pattern[self.pos++];
+    auto range = [&](char lo, char hi) {
+      for (auto b = lo; b <= hi; b++) {
+        set.set(static_cast<uint8_t>(b));
+      }
+    };
+
+    switch (c) {
+    case 'd':
+    case 'D':
+      range('0', '9');
+      break;
+    case 'w':
+    case 'W':
+      range('0', '9');
+      range('a', 'z');
+      range('A', 'Z');
+      set.set('_');
+      break;
+    case 's':
+    case 'S':
+      for (auto b : string_view(" \t\n\r\v\f")) {
+        set.set(static_cast<uint8_t>(b));
+      }
+      break;
+    case 'n':
+      c = '\n';
+      break;
+    case 't':
+      c = '\t';
+      break;
+    case 'r':
+      c = '\r';
+      break;
+    case 'f':
+      c = '\f';
+      break;
+    case 'v':
+      c = '\v';
+      break;
+    default:
+      if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+          (c >= '0' && c <= '9')) {
+        self.pos--;
+        return self.fail(std::format("unknown escape \\{}", c));
+      }
+    }
+
+    if (set.none()) {
+      set.set(static_cast<uint8_t>(c));
+      return c;
+    }
+    if (c == 'D' || c == 'W' || c == 'S') {
+      set.flip();
+    }
+    return c;
+  }
+
+  string_view pattern;
+  std::vector<std::bitset<256>> &classes;
+  size_t pos = 0;
+};
+
+class Compiler {
+public:
+  Compiler(bool reverse) : reverse(reverse) {}
+
+  // reversed programs match the pattern read backwards, with the
+  // order of concatenations and the meaning of ^ and $ swapped
+  auto compile(this Compiler &self, const Node &root,
+               std::vector<std::bitset<256>> classes)
+      -> std::expected<Program, string> {
+    if (!self.node(root)) {
+      return std::unexpected("regex is too large");
+    }
+    self.emit(Op::MATCH);
+
+    // any text then the pattern: SPLIT pattern, any; any: CLASS; JMP
+    auto unanchored = self.emit(Op::SPLIT, 0, self.insts.size() + 1);
+    classes.push_back(std::bitset<256>().set());
+    self.emit(Op::CLASS, classes.size() - 1);
+    self.emit(Op::JMP, unanchored);
+
+    return Program{.insts = std::move(self.insts),
+                   .classes = std::move(classes),
+                   .anchored = 0,
+                   .unanchored = unanchored};
+  }
+
+private:
+  auto emit(this Compiler &self, Op op, size_t x = 0, size_t y = 0)
+      -> uint32_t {
+    self.insts.push_back(Inst{.op = op,
+                              .x = static_cast<uint32_t>(x),
+                              .y = static_cast<uint32_t>(y)});
+    return self.insts.size() - 1;
+  }
+
+  auto here(this const Compiler &self) -> uint32_t {
+    return self.insts.size();
+  }
+
+  auto node(this Compiler &self, const Node &node) -> bool {
+    if (self.insts.size() > MAX_INSTS) {
+      return false;
+    }
+
+    switch (node.kind) {
+    case Node::EMPTY:
+      return true;
+
+    case Node::CLASS:
+      self.emit(Op::CLASS, node.cls);
+      return true;
+
+    case Node::BEGIN:
+      self.emit(self.reverse ? Op::END : Op::BEGIN);
+      return true;
+
+    case Node::END:
+      self.emit(self.reverse ? Op::BEGIN : Op::END);
+      return true;
+
+    case Node::CONCAT:
+      for (size_t i = 0; i < node.children.size(); i++) {
+        auto j = self.reverse ? node.children.size() - 1 - i : i;
+        if (!self.node(node.children[j])) {
+          return false;
+        }
+      }
+      return true;
+
+    case Node::ALT: {
+      // SPLIT a, next; a; JMP end; next: SPLIT b, ... ; last
+      auto jumps = std::vector<uint32_t>();
+      for (size_t i = 0; i + 1 < node.children.size(); i++) {
+        auto split = self.emit(Op::SPLIT, self.here() + 1);
+        if (!self.node(node.children[i])) {
+          return false;
+        }
+        jumps.push_back(self.emit(Op::JMP));
+        self.insts[split].y = self.here();
+      }
+      if (!self.node(node.children.back())) {
+        return false;
+      }
+      for (auto jump : jumps) {
+        self.insts[jump].x = self.here();
+      }
+      return true;
+    }
+
+    case Node::REPEAT:
+      return self.repeat(node);
+    }
+    return true;
+  }
+
+  auto repeat(this Compiler &self, const Node &node) -> bool {
+    auto &child = node.children.front();
+    for (uint32_t i = 0; i + 1 < node.min; i++) {
+      if (!self.node(child)) {
+        return false;
+      }
+    }
+
+    if (node.max == INF) {
+      if (node.min > 0) {
+        // last copy loops: L: child; SPLIT L, out
+        auto loop = self.here();
+        if (!self.node(child)) {
+          return false;
+        }
+        self.emit(Op::SPLIT, loop, self.here() + 1);
+        return true;
+      }
+
+      // L: SPLIT body, out; body: child; JMP L
+      auto split = self.emit(Op::SPLIT, self.here() + 1);
+      if (!self.node(child)) {
+        return false;
+      }
+      self.emit(Op::JMP, split);
+      self.insts[split].y = self.here();
+      return true;
+    }
+
+    if (node.min > 0 && !self.node(child)) {
+      return false;
+    }
+
+    // the optional copies nest, each one skipping all that follow
+    auto splits = std::vector<uint32_t>();
+    for (auto i = node.min; i < node.max; i++) {
+      splits.push_back(self.emit(Op::SPLIT, self.here() + 1));
+      if (!self.node(child)) {
+        return false;
+      }
+    }
+    for (auto split : splits) {
+      self.insts[split].y = self.here();
+    }
+    return true;
+  }
+
+  std::vector<Inst> insts;
+  bool reverse;
+};
+}; // namespace
+
+auto Regex::compile(string_view pattern) -> std::expected<Regex, string> {
+  auto classes = std::vector<std::bitset<256>>();
+  auto root = Parser(pattern, classes).parse();
+  if (!root.has_value()) {
+    return std::unexpected(root.error());
+  }
+
+  auto forward = Compiler(false).compile(root.value(), classes);
+  if (!forward.has_value()) {
+    return std::unexpected(forward.error());
+  }
+  auto reverse = Compiler(true).compile(root.value(), std::move(classes));
+  if (!reverse.has_value()) {
+    return std::unexpected(reverse.error());
+  }
+  return Regex(std::move(forward.value()), std::move(reverse.value()));
+}
@@ -0,0 +1,254 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <regex.hpp>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using namespace regex;
+
+// rough bytes a state costs besides its instructions and transitions,
+// for the map node and the vectors holding it
+static const size_t STATE_OVERHEAD = 96;
+
+Dfa::Dfa(Program prog)
+    : prog(std::move(prog)), byte_class(), stride(1), memory(0),
+      since_flush(0), generation(0) {
+  // bytes no class tells apart share a column of the transition table
+  for (auto &cls : this->prog.classes) {
+    auto ids = std::map<std::pair<uint8_t, bool>, uint8_t>();
+    for (size_t b = 0; b < byte_class.size(); b++) {
+      auto key = std::pair(byte_class[b], cls.test(b));
+      auto it = ids.try_emplace(key, ids.size()).first;
+      byte_class[b] = it->second;
+    }
+    stride = ids.size();
+  }
+
+  seen.resize(this->prog.insts.size());
+  flush();
+}
+
+auto Dfa::program(this const Dfa &self) -> const Program & {
+  return self.prog;
+}
+
+auto Dfa::longest(this Dfa &self, string_view text, size_t from)
+    -> std::optional<size_t> {
+  auto state = self.start(true, from == 0);
+  auto end = NPOS;
+  for (auto i = from; state.has_value(); i++) {
+    if (i == text.size()) {
+      return self.matches_at_end(*state) ? i : end;
+    }
+    if (self.matches(*state)) {
+      end = i;
+    }
+
+    state = self.next(*state, text[i]);
+    if (state == DEAD) {
+      return end;
+    }
+  }
+  return std::nullopt;
+}
+
+auto Dfa::full(this Dfa &self, string_view text) -> std::optional<bool> {
+  auto state = self.start(true, true);
+  for (size_t i = 0; state.has_value(); i++) {
+    if (i == text.size()) {
+      return self.matches_at_end(*state);
+    }
+
+    state = self.next(*state, text[i]);
+    if (state == DEAD) {
+      return false;
+    }
+  }
+  return std::nullopt;
+}
+
+auto Dfa::backward(this Dfa &self, string_view text)
+    -> std::optional<std::vector<bool>> {
+  auto res = std::vector<bool>(text.size() + 1);
+  auto state = self.start(false, true);
+  for (auto i = text.size(); state.has_value(); i--) {
+    if (i == 0) {
+      res[i] = self.matches_at_end(*state);
+      return res;
+    }
+
+    if (self.matches(*state)) {
+      res[i] = true;
+    }
+    state = self.next(*state, text[i - 1]);
+  }
+  return std::nullopt;
+}
+
+auto Dfa::start(this Dfa &self, bool anchored, bool at_begin)
+    -> std::optional<uint32_t> {
+  auto id = self.starts[anchored * 2 + at_begin];
+  if (id != UNKNOWN) {
+    return id;
+  }
+
+  auto set = std::vector<uint32_t>();
+  self.fresh();
+  self.closure(anchored ? self.prog.anchored : self.prog.unanchored,
+               at_begin, false, set);
+  auto res = self.intern(std::move(set));
+  if (res.has_value()) {
+    // starts are reset by a flush inside intern
+    self.starts[anchored * 2 + at_begin] = *res;
+  }
+  return res;
+}
+
+// kept small so the search loops inline the cached case
+auto Dfa::next(this Dfa &self, uint32_t state, uint8_t byte)
+    -> std::optional<uint32_t> {
+  self.since_flush++;
+  auto to = self.table[state * self.stride + self.byte_class[byte]];
+  if (to != UNKNOWN) {
+    return to;
+  }
+  return self.transition(state, byte);
+}
+
+auto Dfa::transition(this Dfa &self, uint32_t state, uint8_t byte)
+    -> std::optional<uint32_t> {
+  auto set = std::vector<uint32_t>();
+  self.fresh();
+  for (auto pc : self.states[state]) {
+    auto &inst = self.prog.insts[pc];
+    if (inst.op == Op::CLASS && self.prog.classes[inst.x].test(byte)) {
+      self.closure(pc + 1, false, false, set);
+    }
+  }
+
+  auto res = self.intern(std::move(set));
+  // a flush inside intern resets since_flush and drops the state the
+  // transition would be recorded on
+  if (res.has_value() && self.since_flush != 0) {
+    self.table[state * self.stride + self.byte_class[byte]] = *res;
+  }
+  return res;
+}
+
+auto Dfa::matches(this const Dfa &self, uint32_t state) -> bool {
+  return self.flags[state] & MATCH;
+}
+
+// the END instructions of a state hold only once the text is over
+auto Dfa::matches_at_end(this Dfa &self, uint32_t state) -> bool {
+  auto flags = self.flags[state];
+  if (flags & END_KNOWN) {
+    return flags & END_MATCH;
+  }
+
+  auto set = std::vector<uint32_t>();
+  self.fresh();
+  for (auto pc : self.states[state]) {
+    if (self.prog.insts[pc].op != Op::CLASS) {
+      self.closure(pc, false, true, set);
+    }
+  }
+
+  auto match = std::ranges::any_of(
+      set, [&](auto pc) { return self.prog.insts[pc].op == Op::MATCH; });
+  self.flags[state] |= END_KNOWN | (match ? END_MATCH : 0);
+  return match;
+}
+
+auto Dfa::fresh(this Dfa &self) -> void {
+  if (++self.generation == 0) {
+    std::ranges::fill(self.seen, 0);
+    self.generation = 1;
+  }
+}
+
+auto Dfa::closure(this Dfa &self, uint32_t pc, bool at_begin, bool at_end,
+                  std::vector<uint32_t> &set) -> void {
+  self.stack.push_back(pc);
+  while (!self.stack.empty()) {
+    pc = self.stack.back();
+    self.stack.pop_back();
+    if (self.seen[pc] == self.generation) {
+      continue;
+    }
+    self.seen[pc] = self.generation;
+
+    auto &inst = self.prog.insts[pc];
+    switch (inst.op) {
+    case Op::CLASS:
+    case Op::MATCH:
+      set.push_back(pc);
+      break;
+    case Op::SPLIT:
+      self.stack.push_back(inst.y);
+      self.stack.push_back(inst.x);
+      break;
+    case Op::JMP:
+      self.stack.push_back(inst.x);
+      break;
+    case Op::BEGIN:
+      if (at_begin) {
+        self.stack.push_back(pc + 1);
+      }
+      break;
+    case Op::END:
+      if (at_end) {
+        self.stack.push_back(pc + 1);
+      } else {
+        set.push_back(pc);
+      }
+      break;
+    }
+  }
+}
+
+auto Dfa::intern(this Dfa &self, std::vector<uint32_t> set)
+    -> std::optional<uint32_t> {
+  std::ranges::sort(set);
+  if (auto it = self.ids.find(set); it != self.ids.end()) {
+    return it->second;
+  }
+
+  auto cost = STATE_OVERHEAD + 2 * set.size() * sizeof(uint32_t) +
+              self.stride * sizeof(uint32_t);
+  if (self.memory + cost > MEMORY_CAP) {
+    // a cache that fills up before being reused a few times over is
+    // slower than the pike vm
+    if (self.since_flush < 10 * self.states.size() ||
+        cost + STATE_OVERHEAD > MEMORY_CAP) {
+      return std::nullopt;
+    }
+    self.flush();
+  }
+
+  auto id = static_cast<uint32_t>(self.states.size());
+  auto match = std::ranges::any_of(
+      set, [&](auto pc) { return self.prog.insts[pc].op == Op::MATCH; });
+  self.memory += cost;
+  self.flags.push_back(match ? MATCH : 0);
+  self.table.resize(self.table.size() + self.stride, UNKNOWN);
+  self.states.push_back(set);
+  self.ids.emplace(std::move(set), id);
+  return id;
+}
+
+// drops every state but the dead one, which is always state 0
+auto Dfa::flush(this Dfa &self) -> void {
+  self.states.clear();
+  self.ids.clear();
+  self.table.clear();
+  self.flags.clear();
+  self.starts.fill(UNKNOWN);
+  self.memory = 0;
+  self.since_flush = 0;
+  self.intern({});
+}
@@ -0,0 +1,113 @@
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <regex.hpp>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using namespace regex;
+
+namespace {
+// sparse set of instructions, each with the position its thread
+// started at. threads are kept in the order they were added
+struct Threads {
+  Threads(size_t size) : sparse(size), dense(size), starts(size) {}
+
+  auto has(uint32_t pc) const -> bool {
+    return sparse[pc] < count && dense[sparse[pc]] == pc;
+  }
+
+  auto insert(uint32_t pc, size_t start) -> void {
+    sparse[pc] = count;
+    dense[count++] = pc;
+    starts[pc] = start;
+  }
+
+  std::vector<uint32_t> sparse;
+  std::vector<uint32_t> dense;
+  std::vector<size_t> starts;
+  size_t count = 0;
+};
+
+// follows SPLIT, JMP and the assertions that hold at pos from pc
+auto add(const Program &prog, Threads &threads, std::vector<uint32_t> &stack,
+         uint32_t pc, size_t start, size_t pos, size_t size) -> void {
+  stack.push_back(pc);
+  while (!stack.empty()) {
+    pc = stack.back();
+    stack.pop_back();
+    if (threads.has(pc)) {
+      continue;
+    }
+    threads.insert(pc, start);
+
+    auto &inst = prog.insts[pc];
+    switch (inst.op) {
+    case Op::CLASS:
+    case Op::MATCH:
+      break;
+    case Op::SPLIT:
+      stack.push_back(inst.y);
+      stack.push_back(inst.x);
+      break;
+    case Op::JMP:
+      stack.push_back(inst.x);
+      break;
+    case Op::BEGIN:
+      if (pos == 0) {
+        stack.push_back(pc + 1);
+      }
+      break;
+    case Op::END:
+      if (pos == size) {
+        stack.push_back(pc + 1);
+      }
+      break;
+    }
+  }
+}
+}; // namespace
+
+// a new thread is started at every position until something matches.
+// threads are ordered by start, and one reaching an instruction first
+// shadows later starts at it, which have the same future. once a match
+// is found only threads starting at or before it keep running, to find
+// the longest match at the leftmost start
+auto regex::pike(const Program &prog, string_view text, size_t from)
+    -> std::optional<std::pair<size_t, size_t>> {
+  auto current = Threads(prog.insts.size());
+  auto next = Threads(prog.insts.size());
+  auto stack = std::vector<uint32_t>();
+  auto best = std::optional<std::pair<size_t, size_t>>();
+
+  for (auto pos = from; pos <= text.size(); pos++) {
+    if (!best.has_value()) {
+      add(prog, current, stack, prog.anchored, pos, pos, text.size());
+    } else if (current.count == 0) {
+      break;
+    }
+
+    for (size_t i = 0; i < current.count; i++) {
+      auto pc = current.dense[i];
+      auto start = current.starts[pc];
+      if (best.has_value() && start > best->first) {
+        break;
+      }
+
+      auto &inst = prog.insts[pc];
+      if (inst.op == Op::MATCH) {
+        if (!best.has_value() || start < best->first || pos > best->second) {
+          best = {start, pos};
+        }
+      } else if (inst.op == Op::CLASS && pos < text.size() &&
+                 prog.classes[inst.x].test(static_cast<uint8_t>(text[pos]))) {
+        add(prog, next, stack, pc + 1, start, pos + 1, text.size());
+      }
+    }
+
+    std::swap(current, next);
+    next.count = 0;
+  }
+  return best;
+}
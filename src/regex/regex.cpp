@@ -0,0 +1,69 @@
+#include <cstddef>
+#include <optional>
+#include <regex.hpp>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using namespace regex;
+
+Regex::Regex(Program forward, Program reverse)
+    : forward(std::move(forward)), reverse(std::move(reverse)) {}
+
+// the dfa cannot tell the start of the text from its end when the
+// text is empty, so empty texts go straight to the pike vm
+auto Regex::full(this Regex &self, string_view text) -> bool {
+  auto res = text.empty() ? std::nullopt : self.forward.full(text);
+  if (res.has_value()) {
+    return *res;
+  }
+
+  auto match = pike(self.forward.program(), text, 0);
+  return match.has_value() && match->first == 0 &&
+         match->second == text.size();
+}
+
+// one backward pass over the text marks every position a match starts
+// at, then each match is the longest one from the next marked start.
+// if either dfa gives up the rest of the text is left to the pike vm
+auto Regex::find_all(this Regex &self, string_view text)
+    -> std::vector<std::pair<size_t, size_t>> {
+  auto res = std::vector<std::pair<size_t, size_t>>();
+  auto starts = text.empty() ? std::nullopt : self.reverse.backward(text);
+  auto last = Dfa::NPOS;
+  size_t pos = 0;
+  while (pos <= text.size()) {
+    auto match = std::optional<std::pair<size_t, size_t>>();
+    if (starts.has_value()) {
+      auto start = pos;
+      while (start <= text.size() && !(*starts)[start]) {
+        start++;
+      }
+      if (start > text.size()) {
+        break;
+      }
+
+      auto end = self.forward.longest(text, start);
+      if (end.has_value()) {
+        match = {start, *end};
+      } else {
+        starts.reset();
+      }
+    }
+
+    if (!starts.has_value()) {
+      match = pike(self.forward.program(), text, pos);
+      if (!match.has_value()) {
+        break;
+      }
+    }
+
+    auto [start, end] = *match;
+    if (start != end || start != last) {
+      res.push_back(*match);
+      last = end;
+    }
+    pos = end > start ? end : start + 1;
+  }
+  return res;
+}
@@ -0,0 +1,123 @@
+#ifndef __ETA_REGEX_HPP__
+#define __ETA_REGEX_HPP__
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using std::string;
+using std::string_view;
+
+// byte oriented regular expressions without backtracking. a pattern
+// compiles to a thompson nfa that runs as a lazily built dfa, or as a
+// pike vm once the dfa outgrows its cache, so a search is linear in
+// the length of the text. matches are leftmost-longest
+namespace regex {
+enum class Op : uint8_t { CLASS, MATCH, SPLIT, JMP, BEGIN, END };
+
+struct Inst {
+  Op op;
+  // CLASS: index into Program::classes, SPLIT: both targets, JMP: x
+  uint32_t x;
+  uint32_t y;
+};
+
+struct Program {
+  std::vector<Inst> insts;
+  std::vector<std::bitset<256>> classes;
+  // entry of the pattern, and of the pattern preceded by any text
+  uint32_t anchored;
+  uint32_t unanchored;
+};
+
+// leftmost-longest match starting at or after from
+auto pike(const Program &prog, string_view text, size_t from)
+    -> std::optional<std::pair<size_t, size_t>>;
+
+// subset construction done on demand. a state is the sorted set of
+// CLASS, MATCH and END instructions live at a position, transitions
+// are filled in the first time they are taken. when the cache grows
+// past MEMORY_CAP it is flushed, and a search gives up (returning
+// nullopt) if the cache keeps filling up faster than it is reused
+class Dfa {
+public:
+  static constexpr size_t MEMORY_CAP = 1 << 21;
+  static constexpr size_t NPOS = string_view::npos;
+
+  Dfa(Program prog);
+  auto program(this const Dfa &self) -> const Program &;
+  // end of the longest match starting at from, NPOS when there is none
+  auto longest(this Dfa &self, string_view text, size_t from)
+      -> std::optional<size_t>;
+  auto full(this Dfa &self, string_view text) -> std::optional<bool>;
+  // runs the program over text read backwards from every position,
+  // res[i] tells whether it matches text[i..j) read from j down to i
+  // for some j >= i
+  auto backward(this Dfa &self, string_view text)
+      -> std::optional<std::vector<bool>>;
+
+private:
+  static constexpr uint32_t UNKNOWN = UINT32_MAX;
+  static constexpr uint32_t DEAD = 0;
+  enum Flag : uint8_t { MATCH = 1, END_KNOWN = 2, END_MATCH = 4 };
+
+  auto start(this Dfa &self, bool anchored, bool at_begin)
+      -> std::optional<uint32_t>;
+  auto next(this Dfa &self, uint32_t state, uint8_t byte)
+      -> std::optional<uint32_t>;
+  auto transition(this Dfa &self, uint32_t state, uint8_t byte)
+      -> std::optional<uint32_t>;
+  auto matches(this const Dfa &self, uint32_t state) -> bool;
+  auto matches_at_end(this Dfa &self, uint32_t state) -> bool;
+  auto fresh(this Dfa &self) -> void;
+  auto closure(this Dfa &self, uint32_t pc, bool at_begin, bool at_end,
+               std::vector<uint32_t> &set) -> void;
+  auto intern(this Dfa &self, std::vector<uint32_t> set)
+      -> std::optional<uint32_t>;
+  auto flush(this Dfa &self) -> void;
+
+  Program prog;
+  std::array<uint8_t, 256> byte_class;
+  size_t stride;
+
+  std::vector<std::vector<uint32_t>> states;
+  std::map<std::vector<uint32_t>, uint32_t> ids;
+  std::vector<uint32_t> table;
+  std::vector<uint8_t> flags;
+  std::array<uint32_t, 4> starts;
+  size_t memory;
+  size_t since_flush;
+
+  std::vector<uint32_t> seen;
+  uint32_t generation;
+  std::vector<uint32_t> stack;
+};
+
+class Regex {
+public:
+  static auto compile(string_view pattern) -> std::expected<Regex, string>;
+  // the whole text matches
+  auto full(this Regex &self, string_view text) -> bool;
+  // non-overlapping matches as [start, end), an empty match right
+  // after the previous match is skipped
+  auto find_all(this Regex &self, string_view text)
+      -> std::vector<std::pair<size_t, size_t>>;
+
+private:
+  Regex(Program forward, Program reverse);
+
+  // the pattern, and the pattern reversed to find where matches start
+  Dfa forward;
+  Dfa reverse;
+};
+}; // namespace regex
+
+#endif
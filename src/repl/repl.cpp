@@ -27,12 +27,13 @@ static const map<string, uint8_t> OPTIONS = {
     {".exit", 4},
 };
 
-auto repl::run() -> void {
+auto repl::run() -> void { run(std::make_shared<object::Environment>()); }
+
+auto repl::run(std::shared_ptr<object::Environment> env) -> void {
   std::println("{}", HELPER);
   std::println("{}", VERSION);
 
   string line;
-  auto env = std::make_shared<object::Environment>();
 
   while (true) {
     std::print("{}", PROMPT);
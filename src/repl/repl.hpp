@@ -1,8 +1,12 @@
 #ifndef __ETA_REPL_HPP__
 #define __ETA_REPL_HPP__
 
+#include <memory>
+#include <object.hpp>
+
 namespace repl {
   auto run() -> void;
+  auto run(std::shared_ptr<object::Environment> env) -> void;
 };
 
 #endif
@@ -0,0 +1,795 @@
+#include <analysis.hpp>
+#include <ast.hpp>
+#include <cache.hpp>
+#include <fcntl.h>
+#include <format>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <object.hpp>
+#include <regex.hpp>
+#include <snapshot.hpp>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <tuple>
+#include <unistd.h>
+#include <vector>
+
+using namespace object;
+using std::string_view;
+
+static const string_view MAGIC = "ETAS";
+// serialized values share the layout of snapshots under their own magic
+static const string_view VALUE_MAGIC = "ETAV";
+
+// ids are 1-based in the image, 0 stands for a missing value
+static const uint64_t NONE = 0;
+
+// array payloads start with their storage kind
+static const uint8_t ARRAY_BOXED = 0;
+static const uint8_t ARRAY_INTS = 1;
+static const uint8_t ARRAY_FLOATS = 2;
+
+namespace {
+// collects every environment and object reachable from the
+// root environment, outer environments always get the smaller id
+struct Graph {
+  std::map<const Environment *, uint64_t> env_ids;
+  std::vector<std::shared_ptr<Environment>> envs;
+  std::map<const Object *, uint64_t> object_ids;
+  std::vector<std::shared_ptr<Object>> objects;
+  std::map<const Slot *, uint64_t> slot_ids;
+  std::vector<std::shared_ptr<Slot>> slots;
+  // name of the first type that can't be written
+  string unsupported;
+
+  auto env(this Graph &self, const std::shared_ptr<Environment> &env) -> void;
+  auto object(this Graph &self, const std::shared_ptr<Object> &obj) -> void;
+  auto slot(this Graph &self, const std::shared_ptr<Slot> &slot) -> void;
+  auto env_id(this const Graph &self, const std::shared_ptr<Environment> &env)
+      -> uint64_t;
+  auto object_id(this const Graph &self, const std::shared_ptr<Object> &obj)
+      -> uint64_t;
+};
+}; // namespace
+
+auto Graph::env(this Graph &self, const std::shared_ptr<Environment> &env)
+    -> void {
+  if (!env || self.env_ids.contains(env.get())) {
+    return;
+  }
+
+  self.env(env->parent());
+  self.envs.push_back(env);
+  self.env_ids[env.get()] = self.envs.size();
+
+  for (const auto &[name, slot] : env->entries()) {
+    self.slot(slot);
+  }
+}
+
+// closures share slots with the scopes they capture from,
+// so slots are numbered on their own to keep that sharing
+auto Graph::slot(this Graph &self, const std::shared_ptr<Slot> &slot) -> void {
+  if (self.slot_ids.contains(slot.get())) {
+    return;
+  }
+
+  self.slots.push_back(slot);
+  self.slot_ids[slot.get()] = self.slots.size();
+  self.object(slot->value);
+}
+
+auto Graph::object(this Graph &self, const std::shared_ptr<Object> &obj)
+    -> void {
+  if (!obj || self.object_ids.contains(obj.get())) {
+    return;
+  }
+
+  self.objects.push_back(obj);
+  self.object_ids[obj.get()] = self.objects.size();
+
+  switch (obj->type()) {
+  case ObjectType::ONULL:
+  case ObjectType::OINT:
+  case ObjectType::OFLOAT:
+  case ObjectType::OBOOL:
+  case ObjectType::OSTRING:
+  case ObjectType::OBITSET:
+  case ObjectType::OMATRIX:
+  case ObjectType::OREGEX:
+  case ObjectType::ORANGE:
+    break;
+
+  case ObjectType::OARRAY: {
+    // packed arrays hold no objects, their scalars are written inline
+    auto arr = object::cast<Object, Array>(obj);
+    if (arr->ints() || arr->floats()) {
+      break;
+    }
+
+    for (size_t i = 0; i < arr->size(); i++) {
+      self.object(arr->at(i));
+    }
+    break;
+  }
+
+  case ObjectType::ODICT:
+    object::cast<Object, Dict>(obj)->each(
+        [&](const auto &key, const auto &value) {
+          self.object(key);
+          self.object(value);
+        });
+    break;
+
+  case ObjectType::OMAP:
+    object::cast<Object, OrderedMap>(obj)->each(
+        nullptr, nullptr, [&](const auto &key, const auto &value) {
+          self.object(key);
+          self.object(value);
+          return true;
+        });
+    break;
+
+  case ObjectType::ODEQUE: {
+    auto deque = object::cast<Object, Deque>(obj);
+    for (size_t i = 0; i < deque->size(); i++) {
+      self.object(deque->at(i));
+    }
+    break;
+  }
+
+  case ObjectType::OPQUEUE: {
+    auto queue = object::cast<Object, PriorityQueue>(obj);
+    self.object(queue->comparator());
+    for (size_t i = 0; i < queue->size(); i++) {
+      self.object(queue->at(i));
+    }
+    break;
+  }
+
+  case ObjectType::OFUNCTION:
+    self.env(object::cast<Object, Function>(obj)->env);
+    break;
+
+  default:
+    if (self.unsupported.empty()) {
+      self.unsupported = OBJECT_TYPE_NAME.contains(obj->type())
+                             ? OBJECT_TYPE_NAME.at(obj->type())
+                             : string("internal value");
+    }
+    break;
+  }
+}
+
+auto Graph::env_id(this const Graph &self,
+                   const std::shared_ptr<Environment> &env) -> uint64_t {
+  return env ? self.env_ids.at(env.get()) : NONE;
+}
+
+auto Graph::object_id(this const Graph &self,
+                      const std::shared_ptr<Object> &obj) -> uint64_t {
+  return obj ? self.object_ids.at(obj.get()) : NONE;
+}
+
+// the header, then every environment, object and slot of the graph.
+// the root is left for the caller to write
+static auto write(cache::Writer &w, string_view magic, const Graph &graph)
+    -> void {
+  w.bytes(magic.data(), magic.size());
+  w.uvar(snapshot::VERSION);
+  w.uvar(cache::VERSION);
+
+  w.uvar(graph.envs.size());
+  for (const auto &e : graph.envs) {
+    w.uvar(graph.env_id(e->parent()));
+  }
+
+  w.uvar(graph.objects.size());
+  for (const auto &obj : graph.objects) {
+    w.u8(obj->type());
+    switch (obj->type()) {
+    case ObjectType::OINT:
+      w.i64(object::cast<Object, Integer>(obj)->value);
+      break;
+
+    case ObjectType::OFLOAT:
+      w.f64(object::cast<Object, Float>(obj)->value);
+      break;
+
+    case ObjectType::OBOOL:
+      w.u8(object::cast<Object, Bool>(obj)->value);
+      break;
+
+    case ObjectType::OSTRING:
+      w.str(object::cast<Object, String>(obj)->view());
+      break;
+
+    case ObjectType::OARRAY: {
+      // packed scalars go out as one block of their raw bytes
+      auto arr = object::cast<Object, Array>(obj);
+      if (auto ints = arr->ints()) {
+        w.u8(ARRAY_INTS);
+        w.uvar(ints->size());
+        w.bytes(ints->data(), ints->size_bytes());
+      } else if (auto floats = arr->floats()) {
+        w.u8(ARRAY_FLOATS);
+        w.uvar(floats->size());
+        w.bytes(floats->data(), floats->size_bytes());
+      } else {
+        w.u8(ARRAY_BOXED);
+        w.uvar(arr->size());
+        for (size_t i = 0; i < arr->size(); i++) {
+          w.uvar(graph.object_id(arr->at(i)));
+        }
+      }
+      break;
+    }
+
+    case ObjectType::ODICT: {
+      auto dict = object::cast<Object, Dict>(obj);
+      w.uvar(dict->size());
+      dict->each([&](const auto &key, const auto &value) {
+        w.uvar(graph.object_id(key));
+        w.uvar(graph.object_id(value));
+      });
+      break;
+    }
+
+    case ObjectType::OMAP: {
+      auto map = object::cast<Object, OrderedMap>(obj);
+      w.uvar(map->size());
+      map->each(nullptr, nullptr, [&](const auto &key, const auto &value) {
+        w.uvar(graph.object_id(key));
+        w.uvar(graph.object_id(value));
+        return true;
+      });
+      break;
+    }
+
+    case ObjectType::OBITSET: {
+      auto bitset = object::cast<Object, Bitset>(obj);
+      w.uvar(bitset->size());
+      w.uvar(bitset->words().size());
+      for (auto word : bitset->words()) {
+        w.u64(word);
+      }
+      break;
+    }
+
+    case ObjectType::OMATRIX: {
+      auto mat = object::cast<Object, Matrix>(obj);
+      w.uvar(mat->rows());
+      w.uvar(mat->cols());
+      w.uvar(mat->values().size());
+      for (auto v : mat->values()) {
+        w.f64(v);
+      }
+      break;
+    }
+
+    // only the pattern, its dfa is rebuilt as it is used again
+    case ObjectType::OREGEX:
+      w.str(object::cast<Object, Regex>(obj)->pattern());
+      break;
+
+    case ObjectType::ORANGE: {
+      auto range = object::cast<Object, Range>(obj);
+      w.i64(range->start);
+      w.i64(range->end);
+      w.i64(range->step);
+      break;
+    }
+
+    case ObjectType::ODEQUE: {
+      auto deque = object::cast<Object, Deque>(obj);
+      w.uvar(deque->size());
+      for (size_t i = 0; i < deque->size(); i++) {
+        w.uvar(graph.object_id(deque->at(i)));
+      }
+      break;
+    }
+
+    // elements are kept in storage order, which is already a heap
+    case ObjectType::OPQUEUE: {
+      auto queue = object::cast<Object, PriorityQueue>(obj);
+      w.uvar(graph.object_id(queue->comparator()));
+      w.uvar(queue->size());
+      for (size_t i = 0; i < queue->size(); i++) {
+        w.uvar(graph.object_id(queue->at(i)));
+      }
+      break;
+    }
+
+    case ObjectType::OFUNCTION: {
+      auto fn = object::cast<Object, Function>(obj);
+      w.uvar(fn->parameters.size());
+      for (const auto &parm : fn->parameters) {
+        cache::encode(w, parm);
+      }
+      cache::encode(w, fn->body);
+      w.uvar(graph.env_id(fn->env));
+      break;
+    }
+
+    default:
+      break;
+    }
+  }
+
+  w.uvar(graph.slots.size());
+  for (const auto &slot : graph.slots) {
+    w.u8(slot->bound);
+    w.uvar(graph.object_id(slot->value));
+  }
+
+  for (const auto &e : graph.envs) {
+    w.uvar(e->entries().size());
+    for (const auto &[name, slot] : e->entries()) {
+      w.str(name);
+      w.uvar(graph.slot_ids.at(slot.get()));
+    }
+  }
+}
+
+auto snapshot::save(const string &path,
+                    const std::shared_ptr<Environment> &env)
+    -> std::expected<void, string> {
+  auto graph = Graph();
+  graph.env(env);
+  if (!graph.unsupported.empty()) {
+    return std::unexpected(
+        std::format("cannot snapshot a {}", graph.unsupported));
+  }
+
+  auto w = cache::Writer();
+  write(w, MAGIC, graph);
+  w.uvar(graph.env_id(env));
+
+  auto out = std::ofstream(path, std::ios::binary | std::ios::trunc);
+  out.write(w.data().data(), w.data().size());
+  if (!out) {
+    return std::unexpected(std::format("failed to write snapshot {}", path));
+  }
+
+  return {};
+}
+
+namespace {
+enum class Header { OK, FOREIGN, STALE };
+
+// everything read back, indexed by id - 1
+struct Image {
+  std::vector<std::shared_ptr<Environment>> envs;
+  std::vector<std::shared_ptr<Object>> objects;
+};
+}; // namespace
+
+static auto header(cache::Reader &r, string_view magic) -> Header {
+  auto magic_ok = true;
+  for (auto c : magic) {
+    magic_ok = magic_ok && r.u8() == static_cast<uint8_t>(c);
+  }
+
+  if (!magic_ok) {
+    return Header::FOREIGN;
+  }
+  if (r.uvar() != snapshot::VERSION || r.uvar() != cache::VERSION) {
+    return Header::STALE;
+  }
+  return Header::OK;
+}
+
+// the counterpart of write, a corrupt image fails the reader
+static auto read(cache::Reader &r) -> Image {
+  std::vector<std::shared_ptr<Environment>> envs;
+  auto env_at = [&](uint64_t id) -> std::shared_ptr<Environment> {
+    if (id > envs.size()) {
+      r.fail();
+    }
+    return (id == NONE || !r.ok()) ? nullptr : envs[id - 1];
+  };
+
+  auto env_count = r.count();
+  for (size_t i = 0; i < env_count && r.ok(); i++) {
+    auto outer = env_at(r.uvar());
+    envs.push_back(outer ? std::make_shared<Environment>(outer)
+                         : std::make_shared<Environment>());
+  }
+
+  std::vector<std::shared_ptr<Object>> objects;
+  std::vector<std::pair<std::shared_ptr<Array>, std::vector<uint64_t>>> arrays;
+  std::vector<std::pair<std::shared_ptr<Dict>,
+                        std::vector<std::pair<uint64_t, uint64_t>>>>
+      dicts;
+  std::vector<std::pair<std::shared_ptr<OrderedMap>,
+                        std::vector<std::pair<uint64_t, uint64_t>>>>
+      maps;
+  std::vector<std::pair<std::shared_ptr<Deque>, std::vector<uint64_t>>> deques;
+  std::vector<std::tuple<std::shared_ptr<PriorityQueue>, uint64_t,
+                         std::vector<uint64_t>>>
+      queues;
+  std::vector<std::pair<std::shared_ptr<Function>, uint64_t>> functions;
+
+  auto object_count = r.count();
+  for (size_t i = 0; i < object_count && r.ok(); i++) {
+    switch (r.u8()) {
+    case ObjectType::ONULL:
+      objects.push_back(OBJECT_NULL);
+      break;
+
+    case ObjectType::OINT:
+      objects.push_back(std::make_shared<Integer>(r.i64()));
+      break;
+
+    case ObjectType::OFLOAT:
+      objects.push_back(std::make_shared<Float>(r.f64()));
+      break;
+
+    case ObjectType::OBOOL:
+      objects.push_back(r.u8() != 0 ? OBJECT_TRUE : OBJECT_FALSE);
+      break;
+
+    case ObjectType::OSTRING:
+      objects.push_back(std::make_shared<String>(r.str()));
+      break;
+
+    case ObjectType::OARRAY: {
+      auto kind = r.u8();
+      if (kind == ARRAY_INTS) {
+        auto elements = Array::Ints(r.count());
+        r.bytes(elements.data(), elements.size() * sizeof(int64_t));
+        objects.push_back(std::make_shared<Array>(std::move(elements)));
+        break;
+      }
+
+      if (kind == ARRAY_FLOATS) {
+        auto elements = Array::Floats(r.count());
+        r.bytes(elements.data(), elements.size() * sizeof(double));
+        objects.push_back(std::make_shared<Array>(std::move(elements)));
+        break;
+      }
+
+      if (kind != ARRAY_BOXED) {
+        r.fail();
+      }
+
+      auto arr = std::make_shared<Array>();
+      auto ids = std::vector<uint64_t>(r.count());
+      for (auto &id : ids) {
+        id = r.uvar();
+      }
+      objects.push_back(arr);
+      arrays.emplace_back(std::move(arr), std::move(ids));
+      break;
+    }
+
+    case ObjectType::ODICT: {
+      auto dict = std::make_shared<Dict>();
+      auto ids = std::vector<std::pair<uint64_t, uint64_t>>(r.count());
+      for (auto &[key, value] : ids) {
+        key = r.uvar();
+        value = r.uvar();
+      }
+      objects.push_back(dict);
+      dicts.emplace_back(std::move(dict), std::move(ids));
+      break;
+    }
+
+    case ObjectType::OMAP: {
+      auto map = std::make_shared<OrderedMap>();
+      auto ids = std::vector<std::pair<uint64_t, uint64_t>>(r.count());
+      for (auto &[key, value] : ids) {
+        key = r.uvar();
+        value = r.uvar();
+      }
+      objects.push_back(map);
+      maps.emplace_back(std::move(map), std::move(ids));
+      break;
+    }
+
+    case ObjectType::OBITSET: {
+      auto bits = r.uvar();
+      auto words = std::vector<uint64_t>(r.count());
+      if (words.size() != bits / 64 + (bits % 64 != 0)) {
+        r.fail();
+        words.clear();
+        bits = 0;
+      }
+      for (auto &word : words) {
+        word = r.u64();
+      }
+      objects.push_back(std::make_shared<Bitset>(bits, std::move(words)));
+      break;
+    }
+
+    case ObjectType::OMATRIX: {
+      auto rows = r.uvar();
+      auto cols = r.uvar();
+      auto values = std::vector<double>(r.count());
+      if (rows * cols != values.size() ||
+          (cols != 0 && rows != values.size() / cols)) {
+        r.fail();
+        values.clear();
+        rows = cols = 0;
+      }
+      for (auto &v : values) {
+        v = r.f64();
+      }
+      objects.push_back(
+          std::make_shared<Matrix>(rows, cols, std::move(values)));
+      break;
+    }
+
+    case ObjectType::OREGEX: {
+      auto pattern = r.str();
+      auto compiled = regex::Regex::compile(pattern);
+      if (!compiled.has_value()) {
+        r.fail();
+        objects.push_back(std::make_shared<Null>());
+        break;
+      }
+      objects.push_back(std::make_shared<Regex>(
+          std::move(pattern),
+          std::make_shared<regex::Regex>(std::move(compiled.value()))));
+      break;
+    }
+
+    case ObjectType::ORANGE: {
+      auto start = r.i64();
+      auto end = r.i64();
+      auto step = r.i64();
+      if (step == 0) {
+        r.fail();
+        step = 1;
+      }
+      objects.push_back(std::make_shared<Range>(start, end, step));
+      break;
+    }
+
+    case ObjectType::ODEQUE: {
+      auto deque = std::make_shared<Deque>();
+      auto ids = std::vector<uint64_t>(r.count());
+      for (auto &id : ids) {
+        id = r.uvar();
+      }
+      objects.push_back(deque);
+      deques.emplace_back(std::move(deque), std::move(ids));
+      break;
+    }
+
+    case ObjectType::OPQUEUE: {
+      auto queue = std::make_shared<PriorityQueue>();
+      auto cmp = r.uvar();
+      auto ids = std::vector<uint64_t>(r.count());
+      for (auto &id : ids) {
+        id = r.uvar();
+      }
+      objects.push_back(queue);
+      queues.emplace_back(std::move(queue), cmp, std::move(ids));
+      break;
+    }
+
+    case ObjectType::OFUNCTION: {
+      auto fn = std::make_shared<Function>();
+      auto count = r.count();
+      for (size_t j = 0; j < count && r.ok(); j++) {
+        auto parm = ast::cast<ast::Node, ast::Identifier>(cache::decode(r));
+        if (!parm) {
+          r.fail();
+        }
+        fn->parameters.push_back(std::move(parm));
+      }
+
+      fn->body = ast::cast<ast::Node, ast::BlockStatement>(cache::decode(r));
+      if (!fn->body) {
+        r.fail();
+      }
+      analysis::run(fn->body);
+
+      objects.push_back(fn);
+      functions.emplace_back(std::move(fn), r.uvar());
+      break;
+    }
+
+    default:
+      r.fail();
+      break;
+    }
+  }
+
+  auto object_at = [&](uint64_t id) -> std::shared_ptr<Object> {
+    if (id > objects.size()) {
+      r.fail();
+    }
+    return (id == NONE || !r.ok()) ? nullptr : objects[id - 1];
+  };
+
+  for (auto &[arr, ids] : arrays) {
+    for (auto id : ids) {
+      auto obj = object_at(id);
+      if (!obj) {
+        r.fail();
+        break;
+      }
+      arr->push(std::move(obj));
+    }
+  }
+
+  for (auto &[dict, ids] : dicts) {
+    for (auto [key, value] : ids) {
+      auto k = object_at(key);
+      auto v = object_at(value);
+      if (!k || !v || !Dict::hashable(k)) {
+        r.fail();
+        break;
+      }
+      dict->set(std::move(k), std::move(v));
+    }
+  }
+
+  for (auto &[map, ids] : maps) {
+    for (auto [key, value] : ids) {
+      auto k = object_at(key);
+      auto v = object_at(value);
+      if (!k || !v || !map->accepts(k)) {
+        r.fail();
+        break;
+      }
+      map->set(std::move(k), std::move(v));
+    }
+  }
+
+  for (auto &[deque, ids] : deques) {
+    for (auto id : ids) {
+      auto obj = object_at(id);
+      if (!obj) {
+        r.fail();
+        break;
+      }
+      deque->push_back(std::move(obj));
+    }
+  }
+
+  for (auto &[queue, cmp, ids] : queues) {
+    auto elements = PriorityQueue::Boxed();
+    for (auto id : ids) {
+      auto obj = object_at(id);
+      if (!obj) {
+        r.fail();
+        break;
+      }
+      elements.push_back(std::move(obj));
+    }
+
+    auto comparator = object_at(cmp);
+    if (comparator && comparator->type() != ObjectType::OFUNCTION) {
+      r.fail();
+    }
+
+    if (!queue->restore(std::move(comparator), std::move(elements))) {
+      r.fail();
+    }
+  }
+
+  for (auto &[fn, id] : functions) {
+    fn->env = env_at(id);
+  }
+
+  std::vector<std::shared_ptr<Slot>> slots;
+  auto slot_count = r.count();
+  for (size_t i = 0; i < slot_count && r.ok(); i++) {
+    auto slot = std::make_shared<Slot>();
+    slot->bound = r.u8() != 0;
+    slot->value = object_at(r.uvar());
+    slots.push_back(std::move(slot));
+  }
+
+  for (auto &env : envs) {
+    auto count = r.count();
+    for (size_t i = 0; i < count && r.ok(); i++) {
+      auto name = r.str();
+      auto id = r.uvar();
+      if (id == NONE || id > slots.size()) {
+        r.fail();
+        break;
+      }
+      env->bind(name, slots[id - 1]);
+    }
+  }
+
+  return Image{std::move(envs), std::move(objects)};
+}
+
+// ids are checked against what was read, a bad one fails the reader
+template <typename T>
+static auto at(cache::Reader &r, const std::vector<std::shared_ptr<T>> &items,
+               uint64_t id) -> std::shared_ptr<T> {
+  if (id == NONE || id > items.size()) {
+    r.fail();
+    return nullptr;
+  }
+  return items[id - 1];
+}
+
+static auto root_env(cache::Reader &r)
+    -> std::expected<std::shared_ptr<Environment>, string> {
+  switch (header(r, MAGIC)) {
+  case Header::FOREIGN:
+    return std::unexpected("not a snapshot file");
+  case Header::STALE:
+    return std::unexpected("snapshot was written by another version of eta");
+  case Header::OK:
+    break;
+  }
+
+  auto image = read(r);
+  auto root = at(r, image.envs, r.uvar());
+  if (!r.ok() || r.remaining() != 0) {
+    return std::unexpected("corrupt snapshot");
+  }
+  return root;
+}
+
+auto snapshot::load(const string &path)
+    -> std::expected<std::shared_ptr<Environment>, string> {
+  auto fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return std::unexpected(std::format("failed to open snapshot {}", path));
+  }
+
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+    ::close(fd);
+    return std::unexpected(std::format("failed to read snapshot {}", path));
+  }
+
+  auto size = static_cast<size_t>(st.st_size);
+  auto mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    return std::unexpected(std::format("failed to map snapshot {}", path));
+  }
+
+  auto r = cache::Reader(static_cast<const char *>(mapping), size,
+                         types::Position::SNAPSHOT);
+  auto res = root_env(r);
+  ::munmap(mapping, size);
+  return res;
+}
+
+auto snapshot::serialize(const std::shared_ptr<Object> &value)
+    -> std::expected<string, string> {
+  auto graph = Graph();
+  graph.object(value);
+  if (!graph.unsupported.empty()) {
+    return std::unexpected(
+        std::format("cannot serialize a {}", graph.unsupported));
+  }
+
+  auto w = cache::Writer();
+  write(w, VALUE_MAGIC, graph);
+  w.uvar(graph.object_id(value));
+  return w.data();
+}
+
+auto snapshot::deserialize(string_view data)
+    -> std::expected<std::shared_ptr<Object>, string> {
+  auto r = cache::Reader(data.data(), data.size(),
+                         types::Position::SERIALIZED);
+  switch (header(r, VALUE_MAGIC)) {
+  case Header::FOREIGN:
+    return std::unexpected("not a serialized value");
+  case Header::STALE:
+    return std::unexpected("value was serialized by another version of eta");
+  case Header::OK:
+    break;
+  }
+
+  auto image = read(r);
+  auto root = at(r, image.objects, r.uvar());
+  if (!r.ok() || r.remaining() != 0) {
+    return std::unexpected("corrupt serialized value");
+  }
+  return root;
+}
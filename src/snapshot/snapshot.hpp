@@ -0,0 +1,29 @@
+#ifndef __ETA_SNAPSHOT_HPP__
+#define __ETA_SNAPSHOT_HPP__
+
+#include <expected>
+#include <memory>
+#include <object.hpp>
+#include <string>
+#include <string_view>
+
+using std::string;
+using std::string_view;
+
+namespace snapshot {
+const uint16_t VERSION = 11;
+
+auto save(const string &path, const std::shared_ptr<object::Environment> &env)
+    -> std::expected<void, string>;
+auto load(const string &path)
+    -> std::expected<std::shared_ptr<object::Environment>, string>;
+
+// a value and everything it reaches in the layout of a snapshot, an
+// object reached twice is written once and comes back shared
+auto serialize(const std::shared_ptr<object::Object> &value)
+    -> std::expected<string, string>;
+auto deserialize(string_view data)
+    -> std::expected<std::shared_ptr<object::Object>, string>;
+}; // namespace snapshot
+
+#endif
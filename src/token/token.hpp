@@ -28,6 +28,7 @@ namespace token {
     TDEFER,
     TFUNC,
     TLET,
+    TIN,
 
     // TYPES
     TINT,
@@ -88,7 +89,7 @@ namespace token {
     "switch",      "case",
     "extern",      "enum",
     "defer",       "function",
-    "let",
+    "let",         "in",
 
     "int",         "float",
     "string",      "bool",
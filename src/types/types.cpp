@@ -5,4 +5,5 @@ Position::Position() {
   cursor  = 0;
   linebeg = 0;
   row     = 0;
+  source  = RUNNING;
 }
@@ -2,12 +2,21 @@
 #define __ETA_TYPES_H__
 
 #include <cstddef>
+#include <cstdint>
 
 namespace types {
   struct Position {
     size_t cursor;
     size_t row;
     size_t linebeg;
+    // the source the position points into, the id of the lexer that
+    // read it or one whose text is not at hand. positions made without
+    // a lexer belong to the source being run
+    uint32_t source;
+
+    static const uint32_t RUNNING = 0;
+    static const uint32_t SNAPSHOT = UINT32_MAX;
+    static const uint32_t SERIALIZED = UINT32_MAX - 1;
 
     Position();
   };
@@ -0,0 +1,20 @@
+#!/bin/sh
+# usage: run.sh <eta> <script> <expected output> [prelude]
+# runs the script and compares what it prints with the expected output.
+# with a prelude, the script runs on a snapshot taken after the prelude
+eta=$1
+script=$2
+expected=$3
+prelude=$4
+
+tmp=$(mktemp -d) || exit 1
+trap 'rm -rf "$tmp"' EXIT
+
+if [ -n "$prelude" ]; then
+  "$eta" --snapshot "$tmp/prelude.snap" "$prelude" || exit 1
+  "$eta" --from-snapshot "$tmp/prelude.snap" "$script" >"$tmp/out" || exit 1
+else
+  "$eta" "$script" >"$tmp/out" || exit 1
+fi
+
+diff -u "$expected" "$tmp/out"